@@ -1,19 +1,58 @@
-#include <map>
-#include <stack>
+#ifndef BRANCH_HPP
+#define BRANCH_HPP
+
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
+#include "../incl/pool.hpp"
+#include "../incl/solver.hpp"
 #include "../incl/utils.hpp"
 
+// Order in which the open nodes of the tree are explored:
+// - best_bound: the node with the smallest lower bound first;
+// - best_estimate: the node with the smallest bound plus the fractionality of
+//   the LP of its parent, a guess of the best coloring under it.
+// Ties go to the deepest node, and to conflict before contract.
+#define BRANCH_SELECTION Branch::selection::best_bound
+// Every BRANCH_DIVE_PERIOD nodes taken from the queue, the search dives
+// depth-first (conflict first) from it until a leaf, to find colorings
+// early. 0 disables the dives.
+#define BRANCH_DIVE_PERIOD 20
+// Strong branching: the BRANCH_CANDIDATES pairs of largest score are compared
+// by the product of the gains of their two children, each estimated with
+// BRANCH_STRONG_ROUNDS rounds of column generation. A pair whose gains were
+// measured BRANCH_RELIABILITY times in each child (by strong branching or by
+// solving them) uses its pseudo-costs instead. 1 candidate disables it.
+#define BRANCH_CANDIDATES 5
+#define BRANCH_STRONG_ROUNDS 5
+#define BRANCH_RELIABILITY 2
+// Smallest gain counted in the product, so one side with no gain still
+// tells the pairs apart by the other
+#define BRANCH_MIN_GAIN 1e-3
+
 class Branch
 {
   public:
+    enum class selection
+    {
+        best_bound,
+        best_estimate
+    };
+
     struct node
     {
-        bool conflict_done;
-        bool contract_done;
-        cost obj_val;
-        Graph::node u, v;
-        vector<node_set> indep_sets;
+        cost obj_val;  // bound of the parent, or of strong branching
+        cost estimate;
+        unsigned long int order;  // tie break: created first, taken first
+        vector<Graph::mod> path;  // changes from the original graph
+        // ids of the sets of the parent in the pool, shared by its children
+        shared_ptr<const vector<column_id>> indep_sets;
+        cost parent_val;  // bound of the parent
+        cost score;  // of the pair in the solution of the parent
+        // sorted ids of the sets fixed to 0 by reduced cost in the parent and
+        // its ancestors, shared by its children
+        shared_ptr<const vector<column_id>> fixed;
     };
 
     Branch() = default;
@@ -21,22 +60,127 @@ class Branch
     /*
     ** Function that determines wheter or not to branch.
     ** It receives an instance of the problem with some independent sets with
-    ** also the current solution (x_s) and the current objective value
-    ** (obj_val).
+    ** also the current solution (x_s, one value for each set) and the current
+    ** objective value (obj_val). The solver evaluates the candidates of
+    ** strong branching, on the graph changed and restored. The sets fixed in
+    ** the node go down to its children.
     */
-    void branch(const Graph&,
-                const vector<node_set>&,
-                const map<node_set, cost>&,
-                const cost&);
+    void branch(Graph&,
+                ColumnPool&,
+                Solver&,
+                const vector<column_id>&,
+                const vector<cost>&,
+                const cost&,
+                const cost& upper_bound,
+                const vector<column_id>& fixed);
 
     /*
     ** Goes to the next node in the branch tree.
-    ** It undoes and does the necessary operations to the graph and the
-    ** independent sets to go to the next node.
-    ** It returns the independent sets of the next node.
+    ** It undoes and does the necessary operations to the graph to go from the
+    ** path of the current node to the one of the next node.
+    ** It returns the independent sets of the next node, adding to the pool the
+    ** singletons needed to cover its nodes. Once out of time, it returns no
+    ** sets and leaves the open nodes in the tree. The sets fixed in the node
+    ** go in fixed.
+    */
+    vector<column_id> next(Graph&,
+                           ColumnPool&,
+                           const cost&,
+                           vector<column_id>& fixed);
+
+    /*
+    ** Lower bound of the whole search: the smallest bound of the open nodes,
+    ** the one last taken by next() included, and at most the upper bound.
     */
-    vector<node_set> next(Graph&, const cost&);
+    cost get_lower_bound(const cost& upper_bound) const;
+
+    // Bound of the node last taken by next(), 0 at the root
+    cost get_taken() const { return has_taken ? taken : 0; }
+
+    void log_stats() const;
+
+    // Open nodes of the tree, for the checkpoints
+    vector<const Branch::node*> get_open() const;
+
+    // Continue the search from these open nodes, read from a checkpoint
+    void resume(vector<Branch::node>&&);
+
+    /*
+    ** Put the node last taken by next(), cut by the time limit, back in the
+    ** open nodes with the bound it reached, if higher. Returns false if no
+    ** node was taken.
+    */
+    bool reopen(const cost& bound);
 
   private:
-    stack<Branch::node> tree;
+    // mean gain of each child per unit of score, conflict then contract
+    struct pseudo_cost
+    {
+        cost sum[2];
+        int count[2];
+    };
+
+    void learn(pseudo_cost&, int child, const cost& gain, const cost& score);
+
+    vector<Branch::node> queue;  // heap of the open nodes
+    vector<Branch::node> children;  // of the last node, not in the queue yet
+    vector<Graph::mod> path;  // applied to the graph
+    unsigned long int created = 0;
+    unsigned long int selected = 0;
+    bool diving = false;
+    unordered_map<uint32_t, pseudo_cost> pseudo;  // by pair
+    // pair, score and parent bound of the last node taken, to learn from it
+    Graph::mod current = {};
+    cost current_score = 0;
+    cost current_parent = 0;
+    cost taken = 0;  // bound of the node last taken, if any
+    bool has_taken = false;
+    Branch::node last = {};  // node last taken, for reopen()
+    int strong_evals = 0;
+    int pseudo_uses = 0;
 };
+
+// Pair of nodes of the graph that may be branched on, with its score
+struct candidate
+{
+    node u, v;
+    cost score;
+};
+
+/*
+** The (at most) k pairs of largest fractional co-membership in the sets of
+** the solution (x_s), from the largest, ties to the smallest pair.
+*/
+vector<candidate> find_candidates(const Graph&,
+                                  const ColumnPool&,
+                                  const vector<column_id>&,
+                                  const vector<cost>&,
+                                  size_t k);
+
+/*
+** Pair of nodes to branch on, the one of largest fractional co-membership in
+** the sets of the solution (x_s). Returns (n, n) if there is none.
+*/
+pair<node, node> find_vertexes(const Graph&,
+                               const ColumnPool&,
+                               const vector<column_id>&,
+                               const vector<cost>&);
+
+/*
+** Sets of the parent that are still independent after the change (t, u, v)
+** is done in the graph, with the singletons needed to cover its nodes.
+*/
+vector<column_id> clean_sets(const Graph&,
+                             ColumnPool&,
+                             const mod_type&,
+                             const vector<column_id>&,
+                             const node&,
+                             const node&);
+
+/*
+** Bring the graph from path to target: the changes after their common prefix
+** are undone, from the last, and the ones of the target are done.
+*/
+void replay(Graph&, vector<Graph::mod>& path, const vector<Graph::mod>& target);
+
+#endif  // BRANCH_HPP
@@ -0,0 +1,68 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "branch.hpp"
+#include "pool.hpp"
+#include "utils.hpp"
+
+// Seconds between two checkpoints of the search
+#define CHECKPOINT_PERIOD 60
+
+// What a checkpoint holds to resume the search
+struct checkpoint_state
+{
+    cost upper_bound;
+    vector<node_set> coloring;  // of the original graph, upper_bound colors
+    vector<node_set> sets;  // the pool, in the order of their ids
+    vector<Branch::node> open;  // nodes left to solve
+};
+
+/*
+** Periodic checkpoints of the sequential search in a binary file: the sets
+** of the pool, the open nodes (their paths of changes, bounds and the ids of
+** the sets of their parents) and the best coloring. The search thread only
+** copies them to a buffer, which a background thread writes to a temporary
+** file and renames over the last checkpoint, so it is never half written.
+** The search takes a last one when it stops.
+*/
+class Checkpoint
+{
+  public:
+    // No checkpoint is written if the file name is empty
+    explicit Checkpoint(string file);
+    Checkpoint(const Checkpoint&) = delete;
+    Checkpoint& operator=(const Checkpoint&) = delete;
+    ~Checkpoint();  // waits for the last write
+
+    /*
+    ** Take a checkpoint if CHECKPOINT_PERIOD seconds passed since the last
+    ** one and it is already written.
+    */
+    void offer(const Graph&,
+               const ColumnPool&,
+               const Branch&,
+               const cost& upper_bound,
+               const vector<node_set>& coloring);
+
+    // Take a checkpoint now, once the last one is written
+    void save(const Graph&,
+              const ColumnPool&,
+              const Branch&,
+              const cost& upper_bound,
+              const vector<node_set>& coloring);
+
+    // Read a checkpoint of a search on the graph
+    static checkpoint_state load(const string& file, const Graph&);
+
+  private:
+    string file;
+    chrono::steady_clock::time_point last;
+    future<void> writing;
+};
+
+#endif  // CHECKPOINT_HPP
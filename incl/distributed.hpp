@@ -0,0 +1,40 @@
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+#include <string>
+#include <vector>
+
+#include "utils.hpp"
+
+// Nodes a worker process solves on its own, depth first from the node it was
+// given, before it sends the open nodes left in its subtree back.
+#define DISTRIBUTED_BATCH 32
+
+/*
+** Coordinator of a branch-and-price spread over config.workers processes.
+** It listens on config.listen (a Unix socket path, or host:port for TCP) and
+** waits for the workers; with no address it listens on a Unix socket in /tmp
+** and starts them itself on this machine, on the same instance. It keeps the
+** open nodes, best bound first, and hands each idle worker one of them with
+** the upper bound and the sets generated by the other workers since its last
+** one. Workers answer with their best coloring, their new sets and the open
+** nodes of the subtree. Returns the number of colors of the best coloring,
+** and sets lower_bound to the least bound of the nodes left open by the time
+** limit (the same number when the search ends).
+** The protocol has no authentication: the Unix socket is only open to our
+** own user and TCP with no host (:port) is on the loopback only, so remote
+** workers need an explicit host (e.g. 0.0.0.0:port) on a trusted network.
+*/
+cost distributed_search(const Graph&,
+                        const vector<node_set>&,
+                        cost upper_bound,
+                        const string& instance,
+                        cost& lower_bound);
+
+/*
+** Worker process: connects to the coordinator at config.connect and solves
+** the subtrees it is given until it is told to stop.
+*/
+void distributed_worker(const Graph&);
+
+#endif  // DISTRIBUTED_HPP
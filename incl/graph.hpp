@@ -42,6 +42,7 @@ class Graph
     // === Constructors ======================================
     explicit Graph(int);
     Graph(const Graph&);
+    Graph(Graph&&) noexcept = default;
 
     // === Getters ===========================================
     node get_n() const;  // number of active nodes
@@ -53,6 +54,11 @@ class Graph
     node get_node_max_degree() const;
     node get_node_min_degree() const;
     inline bool is_active(node u) const { return active[u]; }
+    inline const bitset<MAX_NODES>& get_active() const { return active; }
+    inline const bitset<MAX_NODES>& get_adj_bool(node u) const
+    {
+        return adj_bool[u];
+    }
 
     /*
      * @brief Get the number of edges beteween two nodes. If either are
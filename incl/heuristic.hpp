@@ -2,8 +2,38 @@
 #define HEURISTIC_H
 
 #include "../incl/graph.hpp"
+#include "../incl/pool.hpp"
+#include "../incl/solver.hpp"
 #include "../incl/utils.hpp"
 
+// Diving: at the root and then every DIVE_PERIOD nodes solved, the solution of
+// the node is rounded by fixing its set of largest fractional value, one
+// after the other, with DIVE_ROUNDS rounds of column generation after each
+// fix. Each dive that finds no better coloring doubles the period until the
+// next one, and the dives get at most DIVE_TIME_SHARE of the time spent so
+// far. Each one stops after DIVE_TIME_SHARE of the time left before the time
+// limit. A DIVE_PERIOD of 0 disables them.
+#define DIVE_PERIOD 10
+#define DIVE_ROUNDS 10
+#define DIVE_TIME_SHARE 0.1
+
 cost heuristic(const Graph&, vector<node_set>&);
 
+/*
+** Dive from the node given by the graph, its sets and their values in x_s.
+** Fixing a set contracts its nodes into one, so the graph is changed during
+** the dive and restored at its end. The dive stops when no fractional set has
+** two nodes left to contract, or once elapsed() passes the deadline. Returns
+** the number of colors of the coloring found, in the original graph, or 0 if
+** the dive reached no coloring better than the upper bound.
+*/
+cost dive(Graph&,
+          ColumnPool&,
+          Solver&,
+          vector<column_id>,
+          vector<cost>,
+          const cost& upper_bound,
+          double deadline,
+          vector<node_set>& coloring);
+
 #endif  // HEURISTIC_H
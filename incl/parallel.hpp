@@ -0,0 +1,159 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/*
+** Pool of tasks for a fixed number of workers, one deque per worker.
+** A worker pushes and pops at the back of its own deque (depth first), and
+** when it is empty it steals from the front of the others (the tasks closest
+** to the root, usually the largest ones).
+** Every task popped must be followed by a call to done() once its children
+** have been pushed; pop() returns nothing only when no task is left and no
+** worker is still processing one. A worker with nothing to steal sleeps until
+** a task is pushed or the last one is done; the pushes only take the lock
+** when some worker sleeps.
+*/
+template<typename T>
+class WorkPool
+{
+  public:
+    explicit WorkPool(unsigned int n_workers)
+        : pending(0)
+        , queued(0)
+        , sleeping(0)
+    {
+        for (unsigned int i = 0; i < n_workers; i++) {
+            deques.push_back(make_unique<worker_deque>());
+        }
+    }
+
+    unsigned int get_n_workers() const { return deques.size(); }
+
+    void push(unsigned int worker, T&& task)
+    {
+        pending++;
+        {
+            lock_guard<mutex> const lock(deques[worker]->m);
+            deques[worker]->q.push_back(std::move(task));
+        }
+        queued++;
+        if (sleeping > 0) {
+            lock_guard<mutex> const lock(m);
+            wake.notify_one();
+        }
+    }
+
+    optional<T> pop(unsigned int worker)
+    {
+        while (true) {
+            {
+                worker_deque& own = *deques[worker];
+                lock_guard<mutex> const lock(own.m);
+                if (not own.q.empty()) {
+                    T task = std::move(own.q.back());
+                    own.q.pop_back();
+                    queued--;
+                    return task;
+                }
+            }
+            for (unsigned int i = 1; i < deques.size(); i++) {
+                worker_deque& other = *deques[(worker + i) % deques.size()];
+                lock_guard<mutex> const lock(other.m);
+                if (not other.q.empty()) {
+                    T task = std::move(other.q.front());
+                    other.q.pop_front();
+                    queued--;
+                    return task;
+                }
+            }
+            unique_lock<mutex> lock(m);
+            sleeping++;
+            wake.wait(lock, [this] { return queued > 0 or pending == 0; });
+            sleeping--;
+            if (queued == 0 and pending == 0) {
+                return nullopt;
+            }
+        }
+    }
+
+    void done()
+    {
+        if (--pending == 0) {
+            lock_guard<mutex> const lock(m);
+            wake.notify_all();
+        }
+    }
+
+  private:
+    struct worker_deque
+    {
+        mutex m;
+        deque<T> q;
+    };
+
+    vector<unique_ptr<worker_deque>> deques;
+    atomic<long> pending;  // tasks pushed and not yet done
+    atomic<long> queued;  // tasks in the deques
+    // the workers with nothing to steal wait on wake
+    mutex m;
+    condition_variable wake;
+    atomic<int> sleeping;
+};
+
+/*
+** Lock-free sink (a Treiber stack) where many threads can push values that
+** are only read once all of them are finished.
+*/
+template<typename T>
+class Sink
+{
+  public:
+    Sink() = default;
+    Sink(const Sink&) = delete;
+    Sink& operator=(const Sink&) = delete;
+    ~Sink() { (void)drain(); }
+
+    void push(T value)
+    {
+        auto* n = new sink_node {std::move(value), head.load()};
+        while (not head.compare_exchange_weak(n->next, n)) {
+        }
+    }
+
+    /*
+    ** Take every value pushed so far, in the order they were pushed.
+    */
+    vector<T> drain()
+    {
+        sink_node* n = head.exchange(nullptr);
+        vector<T> values = {};
+        while (n != nullptr) {
+            values.push_back(std::move(n->value));
+            sink_node* const next = n->next;
+            delete n;
+            n = next;
+        }
+        return {values.rbegin(), values.rend()};
+    }
+
+  private:
+    struct sink_node
+    {
+        T value;
+        sink_node* next;
+    };
+
+    atomic<sink_node*> head = nullptr;
+};
+
+#endif  // PARALLEL_HPP
@@ -0,0 +1,92 @@
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "utils.hpp"
+
+// Sets of the pool whose weighted sums are computed side by side
+#define POOL_LANES 8
+
+// Index of a set in the pool, it never changes during the search
+using column_id = unsigned int;
+
+/*
+** Global pool with every independent set generated by the search, shared by
+** all the nodes of the tree, which only refer to the sets by their ids. Each
+** set is kept once, as a bitset over the nodes of the original graph indexed
+** by a 64-bit hash of its words, and as the sorted array of its members.
+** For the reduced cost scan the members are also kept in blocks of
+** POOL_LANES sets, stored member by member and padded with a node of weight
+** 0, so the weights of a whole block are summed with the same instructions.
+*/
+class ColumnPool
+{
+  public:
+    // Members of a set, as a range over the pool storage
+    struct members
+    {
+        const node* first;
+        const node* last;
+
+        const node* begin() const { return first; }
+        const node* end() const { return last; }
+        size_t size() const { return last - first; }
+    };
+
+    explicit ColumnPool(node n);
+
+    // Add the set if it is not in the pool yet, returns its id
+    column_id insert(const node_set&);
+
+    members get_members(column_id id) const
+    {
+        return {&nodes[offsets[id]], &nodes[offsets[id + 1]]};
+    }
+    bool contains(column_id id, node u) const
+    {
+        return (get_bits(id)[u / 64] >> (u % 64)) & 1;
+    }
+    node_set get_set(column_id id) const;
+    vector<node_set> get_sets(const vector<column_id>&) const;
+
+    // Take the active nodes and the edges of g as bitsets for the scans
+    void set_graph(const Graph& g);
+
+    /*
+    ** The sets of the pool that are independent in the last graph set and
+    ** violated by the weights (their sum is greater than 1), at most
+    ** max_sets of them from the most violated.
+    */
+    vector<column_id> violated(const vector<cost>& weight,
+                               size_t max_sets) const;
+
+    size_t size() const { return hashes.size(); }
+
+  private:
+    struct block
+    {
+        node length;          // size of the largest set of the block
+        vector<unsigned> members;  // member k of lane j at k * POOL_LANES + j
+    };
+
+    const uint64_t* get_bits(size_t id) const { return &bits[id * words]; }
+    bool is_valid(size_t id) const;
+
+    node n;
+    size_t words;           // words of each bitset
+    vector<uint64_t> bits;  // bitsets of all sets, one after the other
+    vector<uint64_t> hashes;
+    vector<node> nodes;      // members of all sets, one after the other
+    vector<size_t> offsets;  // where the members of each set start
+    unordered_multimap<uint64_t, size_t> index;
+    vector<block> blocks;
+
+    // active nodes and adjacency of the current graph
+    vector<uint64_t> active;
+    vector<uint64_t> adjacency;
+};
+
+#endif  // POOL_HPP
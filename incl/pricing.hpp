@@ -5,9 +5,34 @@
 
 #include "utils.hpp"
 
+// Maximum number of columns returned by each call of pricing::solve.
+#define PRICING_MAX_COLUMNS 10
+// Criterion used to choose which violated sets are returned, from the most
+// violated to the least:
+// - overlap: a set may share at most PRICING_MAX_OVERLAP of the nodes of the
+//   smallest of the two with each set already chosen;
+// - coverage: a set must cover at least PRICING_MIN_NEW_NODES nodes not yet
+//   covered by the sets already chosen.
+#define PRICING_DIVERSITY pricing::diversity::coverage
+#define PRICING_MAX_OVERLAP 0.5
+#define PRICING_MIN_NEW_NODES 1
+// Once a node of the pricing branch-and-bound has at most this many active
+// nodes, its MWIS is solved exactly over 64-bit masks (at most 64).
+#define PRICING_SMALL_GRAPH 64
+
 namespace pricing
 {
-vector<node_set> solve(const Graph&, const vector<cost>&);
+enum class diversity
+{
+    overlap,
+    coverage
+};
+
+/*
+** Search the independent sets violated by the weights, returning the chosen
+** ones and setting mwis to the value of the maximum weight independent set.
+*/
+vector<node_set> solve(const Graph&, const vector<cost>&, cost& mwis);
 }  // namespace pricing
 
 #endif
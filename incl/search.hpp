@@ -0,0 +1,74 @@
+#ifndef SEARCH_HPP
+#define SEARCH_HPP
+
+#include <memory>
+#include <vector>
+
+#include "pool.hpp"
+#include "solver.hpp"
+#include "utils.hpp"
+
+// Open node of the tree, which does not depend on the pool of any worker
+struct open_node
+{
+    cost obj_val;  // bound of the parent
+    vector<Graph::mod> path;  // changes from the original graph
+    // sets of the parent, shared by its children
+    shared_ptr<const vector<node_set>> indep_sets;
+};
+
+/*
+** Copy of the graph, column pool and master LP with which one worker solves
+** the open nodes of the tree, in any order.
+*/
+class TreeWorker
+{
+  public:
+    explicit TreeWorker(const Graph&);
+    TreeWorker(const TreeWorker&) = delete;
+    TreeWorker& operator=(const TreeWorker&) = delete;
+
+    /*
+    ** Solve the node unless the upper bound prunes it, adding its children to
+    ** children (conflict last). If its LP solution is integral, returns its
+    ** number of colors with the coloring of the original graph, else 0. Once
+    ** out of time, the node itself goes to children, still open with the
+    ** bound it reached.
+    */
+    cost process(const open_node&,
+                 const cost& upper_bound,
+                 vector<node_set>& coloring,
+                 vector<open_node>& children);
+
+    // Add sets generated by other workers to the pool, they are not given by
+    // new_columns
+    void add_columns(const vector<node_set>&);
+
+    // Sets added to the pool since the last call
+    vector<node_set> new_columns();
+
+    void log_stats() const { _solver.log_stats(); }
+
+  private:
+    Graph _g;
+    vector<Graph::mod> _path;  // applied to the graph
+    ColumnPool _pool;
+    Solver _solver;
+    size_t _reported = 0;  // sets of the pool already given by new_columns
+};
+
+/*
+** Branch-and-price over config.tree_threads workers, each with its own
+** TreeWorker. The open nodes are shared in a work-stealing pool, so any
+** worker can take them. Every worker prunes against the same upper bound,
+** starting from the one given.
+** Returns the number of colors of the best coloring found, and sets
+** lower_bound to the least bound of the nodes left open by the time limit
+** (the same number when the search ends).
+*/
+cost parallel_search(const Graph&,
+                     const vector<node_set>&,
+                     cost upper_bound,
+                     cost& lower_bound);
+
+#endif  // SEARCH_HPP
@@ -1,20 +1,176 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 
-#include <map>
+#include <memory>
 #include <vector>
 
-#include <gurobi_c++.h>
-
+#include "pool.hpp"
 #include "utils.hpp"
 
-class Solver
+// Feasibility and optimality tolerance of the built-in simplex
+#define SIMPLEX_TOL EPS
+// Smallest pivot accepted by the ratio tests and the factorization
+#define SIMPLEX_PIVOT_TOL 1e-7
+// Pivots kept as eta vectors before the basis is factorized again
+#define SIMPLEX_REFACTOR 64
+// Degenerate pivots in a row before the primal simplex perturbs the bounds, or
+// uses Bland's rule once they were, and before the dual simplex perturbs the
+// costs, all by up to twice SIMPLEX_PERTURBATION
+#define SIMPLEX_DEGENERATE 50
+#define SIMPLEX_DUAL_DEGENERATE 500
+#define SIMPLEX_PERTURBATION 1e-6
+// Pivots of one dual simplex before it gives up and the master restarts from
+// the basis of the surpluses
+#define SIMPLEX_MAX_PIVOTS 10000
+// Share of the columns of the master fixed to 0 out of the node above which
+// they are deleted
+#define SIMPLEX_COMPACT 0.5
+
+// Wentges smoothing of the duals given to the pricing: it sees
+// alpha * center + (1 - alpha) * duals, where the center is the dual point
+// with the best Farley bound found in the node. 0 disables it.
+#define SMOOTHING_ALPHA 0.5
+// Adapt alpha after each round from the subgradient at the smoothed point
+#define SMOOTHING_AUTO true
+
+// Columns that stay nonbasic with a reduced cost above PURGE_REDUCED_COST for
+// PURGE_AGE rounds in a row leave the master. They stay in the column pool
+// and come back when the duals violate them again. A PURGE_AGE of 0 disables
+// it.
+#define PURGE_AGE 5
+#define PURGE_REDUCED_COST 0.1
+
+// Tailing off: a node whose LP improved by less than TAILING_OFF_EPS (relative
+// to its value) over the last TAILING_OFF_ROUNDS rounds stops the column
+// generation and branches on its fractional solution with the best Lagrangian
+// bound found. The root is always solved to the end, as its bound is the one
+// of the whole search. A TAILING_OFF_ROUNDS of 0 disables it.
+#define TAILING_OFF_ROUNDS 10
+#define TAILING_OFF_EPS 1e-3
+
+// Reduced-cost fixing: at the end of a node, a set out of the LP solution
+// whose reduced cost, at the best dual feasible point of the node, lifts its
+// bound to the upper bound is in no better coloring of the subtree. It leaves
+// the sets given to the children and is not added back to their LPs.
+#define REDUCED_COST_FIXING true
+
+/*
+** Restricted master problem of the column generation: a covering LP with one
+** column (of cost 1) for each independent set and one row for each node of
+** the original graph, whose right-hand side is 1 if the node is active and 0
+** otherwise. The columns are the sets of the pool, given by their ids.
+** The master is kept for the whole search, so each node starts from the basis
+** of the node solved before it. Each executable is linked with one of its
+** implementations:
+** - solver_primal.cpp: Gurobi over the covering LP;
+** - solver_dual.cpp: Gurobi over its dual, the packing LP;
+** - solver_simplex.cpp: built-in bounded simplex, no Gurobi required.
+*/
+class Master
+{
+  public:
+    explicit Master(const ColumnPool&);
+    ~Master();
+
+    /*
+    ** Make the LP represent the node given by the graph and its independent
+    ** sets: rows of inactive nodes are relaxed, columns of sets that are not
+    ** in the node are disabled and the missing ones are added.
+    */
+    void sync(const Graph&, const vector<column_id>&);
+
+    // Add a column for each of the sets, all at once.
+    void add_columns(const vector<column_id>&);
+
+    // Take the columns of the sets out of the LP.
+    void remove_columns(const vector<column_id>&);
+
+    // Solve the LP and return its objective value, or infinity if it has no
+    // feasible solution with its columns.
+    cost optimize();
+
+    // Dual value of the row of each active node.
+    void get_duals(const Graph&, vector<cost>&) const;
+
+    // Value of the column of the set in the last solution.
+    cost get_value(column_id) const;
+
+    void log_stats() const;
+
+  private:
+    struct impl;
+    const ColumnPool& _pool;
+    unique_ptr<impl> _impl;
+};
+
+// Only the nodes of the search count as nodes, and only the root is solved to
+// the end; strong branching and dives probe the LP of a node that is not one
+enum class solve_type
 {
-    GRBEnv _env;
+    root,
+    node,
+    probe
+};
 
+class Solver
+{
   public:
-    Solver();
-    cost solve(const Graph&, vector<node_set>&, map<node_set, cost>&);
+    // The sets of every node are taken from and added to the pool
+    explicit Solver(ColumnPool&);
+
+    /*
+    ** Solve the LP of the node given by the graph and its sets, returning a
+    ** lower bound for it and the values of the sets in x_s, in the same
+    ** order as the sets. With max_rounds, the column generation stops after
+    ** that many LPs, as in the evaluations of strong branching.
+    ** With fixed (sorted ids of the sets fixed to 0 in the node), those sets
+    ** are kept out of the LP while the pricing finds others, and the ones
+    ** fixed by their reduced cost at the end of the node leave the sets and
+    ** are added to it. The type tells the root, which the caller knows from
+    ** its branching path, from the other nodes and the probes.
+    */
+    cost solve(const Graph&,
+               vector<column_id>&,
+               vector<cost>& x_s,
+               const cost& upper_bound,
+               int max_rounds = 0,
+               vector<column_id>* fixed = nullptr,
+               solve_type type = solve_type::probe);
+
+    // Objective of the last LP solved
+    cost get_objective() const { return _objective; }
+
+    // Totals of the column generation over all the nodes solved
+    void log_stats() const;
+
+  private:
+    void age_columns(vector<column_id>&, const vector<cost>&);
+    void fix_columns(vector<column_id>&,
+                     vector<cost>& x_s,
+                     const vector<cost>& duals,
+                     const cost& bound,
+                     const cost& upper_bound,
+                     vector<column_id>& fixed);
+    bool is_fractional(const vector<column_id>&) const;
+
+    // every set generated so far
+    ColumnPool& _pool;
+    Master _master;
+    cost _alpha = SMOOTHING_ALPHA;
+    cost _objective = 0;
+    // rounds in a row each column of the pool looked useless
+    vector<int> _age;
+
+    int _nodes = 0;
+    int _rounds = 0;
+    int _mispricings = 0;
+    int _bound_stops = 0;
+    int _tailing_offs = 0;
+    int _purged = 0;
+    int _restored = 0;
+    int _fixed = 0;
+    double _lp_time = 0;
+    double _pricing_time = 0;
 };
 
 #endif  // SOlVER_H
@@ -2,6 +2,7 @@
 
 #define UTILS_H
 
+#include <algorithm>
 #include <map>
 #include <set>
 #include <string>
@@ -36,18 +37,64 @@ using namespace std;
 using color = unsigned int;
 using cost = long double;  // might not be necessary
 
+// === Runtime configuration ==================================================
+struct Config
+{
+    // threads used by the pricing branch-and-bound, of each tree worker
+    unsigned int threads;
+    // parallel searches give the same result on every run of the same input
+    bool reproducible;
+    // workers of the branch-and-price tree, each with its own graph and LP
+    unsigned int tree_threads;
+    // worker processes of a distributed search, the address the coordinator
+    // listens on and the one a worker process connects to
+    unsigned int workers;
+    string listen;
+    string connect;
+    // file of the periodic checkpoints, and the one the search resumes from
+    string checkpoint;
+    string resume;
+    // seconds of wall clock the search may take
+    double time_limit;
+};
+extern Config config;
+
+/*
+** Read the options given after the instance:
+**   --threads N       (default: 1 if SINGLE_THREAD, else all cores)
+**   --reproducible
+**   --tree-threads N  (default: 1, the threads are split between them)
+**   --workers N       (default: 0, no distributed search)
+**   --listen ADDRESS  (default: a Unix socket, with the workers started here;
+**                      host:port for TCP, on the loopback with no host)
+**   --connect ADDRESS (run as a worker of the coordinator at ADDRESS)
+**   --checkpoint FILE (default: none, or the file resumed from)
+**   --resume FILE     (both only with the sequential search)
+**   --time-limit S    (default: TIMELIMIT)
+*/
+void parse_args(int argc, char** argv);
+
+// === Time limit =============================================================
+// Seconds since the start of the run
+double elapsed();
+// Whether config.time_limit is spent: every long loop checks it and stops
+bool time_out();
+
 // === DIMACS functions =======================================================
 Graph* read_dimacs_instance(const string& filename);
 
 // === Log functions ==========================================================
 void log_solution(const Graph& g,
                   const vector<node_set>& indep_sets,
-                  map<node_set, cost>& x_s,
+                  const vector<cost>& x_s,
                   const cost& sol);
 void log_graph_stats(const Graph& g, const string& name);
+// A new upper or lower bound of the search, as "BOUND <seconds> <name> <value>"
+void log_bound(const char* name, const cost& value);
 
 // === Check functions ========================================================
-bool integral(const map<node_set, cost>&);
+bool integral(const vector<cost>&);
+bool is_all_active(const Graph&, const node_set&);
 bool check_indep_set(const Graph&, const node_set&);
 bool check_indep_sets(const Graph&, const vector<node_set>&);
 
@@ -55,6 +102,12 @@ bool check_indep_sets(const Graph&, const vector<node_set>&);
 void maximal_set(const Graph&, node_set&);
 void enrich(const Graph& g, vector<node_set>& indep_sets);
 
+// === Hash functions =========================================================
+struct node_set_hash
+{
+    size_t operator()(const node_set&) const;
+};
+
 // === String functions =======================================================
 string to_string(const node_set&);
 inline string to_string(const mod_type& t)
@@ -1,5 +1,9 @@
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
+#include <unordered_map>
 
 #include "../incl/branch.hpp"
 
@@ -8,165 +12,397 @@
 int visited = 0;
 
 // TODO Conferir regra para definir em qual vértice dar branch
-pair<node, node> find_vertexes(const Graph& g,
-                               const vector<node_set>& indep_set,
-                               map<node_set, cost> x_s)
+vector<candidate> find_candidates(const Graph& g,
+                                  const ColumnPool& pool,
+                                  const vector<column_id>& indep_set,
+                                  const vector<cost>& x_s,
+                                  size_t k)
 {
     const cost half = 0.5;
 
-    vector<vector<cost>> diff(g.get_n(), vector<cost>(g.get_n(), 0));
-    for (const node_set& set : indep_set) {
-        for (node const u : set) {
-            DCHECK_F(g.is_active(u),
+    // only the pairs of some fractional set get a score
+    unordered_map<uint32_t, cost> diff;
+    for (size_t i = 0; i < indep_set.size(); i++) {
+        cost const score = half - abs(half - x_s[i]);
+        if (score <= 0 + EPS) {
+            continue;
+        }
+        ColumnPool::members const set = pool.get_members(indep_set[i]);
+        for (const node* a = set.begin(); a != set.end(); a++) {
+            DCHECK_F(g.is_active(*a),
                      "node that is not active is in indep sets.");
-            for (node const v : set) {
-                DCHECK_F(g.is_active(v),
-                         "node that is not active is in indep sets.");
-                if (u < v) {
-                    diff[u][v] += half - abs(half - x_s.at(set));
-                }
+            for (const node* b = a + 1; b != set.end(); b++) {
+                diff[(uint32_t)*a * g.get_n() + *b] += score;
             }
         }
     }
 
-    cost max = 0;
-    node u = 0;
-    node v = 0;
-    for_nodes(g, _u)
-        for_nodes(g, _v)
-            if (max < diff[_u][_v] and g.get_adjacency(_u, _v) == 0) {
-                max = diff[_u][_v];
-                u = _u;
-                v = _v;
-            }
+    vector<candidate> candidates = {};
+    for (auto const [key, score] : diff) {
+        node const u = key / g.get_n();
+        node const v = key % g.get_n();
+        if (score > 0 + EPS and g.get_adjacency(u, v) == 0) {
+            candidates.push_back({u, v, score});
+        }
+    }
+    k = min(k, candidates.size());
+    partial_sort(candidates.begin(),
+                 candidates.begin() + k,
+                 candidates.end(),
+                 [](const candidate& a, const candidate& b)
+                 {
+                     if (a.score != b.score) {
+                         return a.score > b.score;
+                     }
+                     return make_pair(a.u, a.v) < make_pair(b.u, b.v);
+                 });
+    candidates.resize(k);
+    return candidates;
+}
 
-    if (max <= 0 + EPS) {
+pair<node, node> find_vertexes(const Graph& g,
+                               const ColumnPool& pool,
+                               const vector<column_id>& indep_set,
+                               const vector<cost>& x_s)
+{
+    vector<candidate> const best = find_candidates(g, pool, indep_set, x_s, 1);
+    if (best.empty()) {
         return make_pair(g.get_n(), g.get_n());
     }
+    return make_pair(best[0].u, best[0].v);
+}
 
-    return make_pair(u, v);
+void Branch::learn(pseudo_cost& p,
+                   int child,
+                   const cost& gain,
+                   const cost& score)
+{
+    p.sum[child] += max((cost)0, gain) / score;
+    p.count[child]++;
 }
 
 /*
 ** Function that determines wheter or not to branch.
-** If so, add the branch to the "tree" (stack).
+** If so, add the two children of the node (conflict and contract) to the tree.
+** With strong branching, the pair chosen is the candidate of largest product
+** of the gains of its children, and the bounds found for them are kept.
 */
-void Branch::branch(const Graph& g,
-                    const vector<node_set>& indep_sets,
-                    const map<node_set, cost>& x_s,
-                    const cost& obj_val)
+void Branch::branch(Graph& g,
+                    ColumnPool& pool,
+                    Solver& solver,
+                    const vector<column_id>& indep_sets,
+                    const vector<cost>& x_s,
+                    const cost& obj_val,
+                    const cost& upper_bound,
+                    const vector<column_id>& fixed)
 {
     LOG_SCOPE_F(INFO, "Branch::Branch");
-    auto [u, v] = find_vertexes(g, indep_sets, x_s);
-    if (u >= g.get_n() || v >= g.get_n()) {
+    auto const key = [&g](Graph::node u, Graph::node v)
+    { return (uint32_t)u * g.get_n() + v; };
+
+    // the node just solved measures the gain of the pair it comes from
+    if (current_score > 0) {
+        learn(pseudo[key(current.u, current.v)],
+              current.t == mod_type::contract,
+              obj_val - current_parent,
+              current_score);
+        current_score = 0;
+    }
+
+    vector<candidate> const candidates =
+        find_candidates(g, pool, indep_sets, x_s, BRANCH_CANDIDATES);
+    if (candidates.empty()) {
         return;
     }
 
-    LOG_F(INFO, "Adding branch on %d and %d", u, v);
-    tree.push(Branch::node {false, false, obj_val, u, v, indep_sets});
+    candidate best = candidates[0];
+    cost best_bound[2] = {obj_val, obj_val};
+    cost best_product = -1;
+    for (size_t c = 0; candidates.size() > 1 and c < candidates.size(); c++) {
+        auto const [u, v, score] = candidates[c];
+        pseudo_cost& p = pseudo[key(u, v)];
+        cost gain[2] = {0, 0};
+        cost bound[2] = {obj_val, obj_val};
+        if (p.count[0] >= BRANCH_RELIABILITY and
+            p.count[1] >= BRANCH_RELIABILITY) {
+            for (int child = 0; child < 2; child++) {
+                gain[child] = score * p.sum[child] / p.count[child];
+            }
+            pseudo_uses++;
+        } else {
+            for (int child = 0; child < 2; child++) {
+                mod_type const t =
+                    child == 0 ? mod_type::conflict : mod_type::contract;
+                g.change(t, u, v);
+                vector<column_id> sets =
+                    clean_sets(g, pool, t, indep_sets, u, v);
+                vector<cost> x;
+                bound[child] = max(
+                    obj_val,
+                    solver.solve(g, sets, x, upper_bound, BRANCH_STRONG_ROUNDS));
+                g.undo(t, u, v);
+
+                // a child pruned by its bound is the best gain there is
+                cost const value = ceil(bound[child]) >= upper_bound
+                    ? upper_bound
+                    : solver.get_objective();
+                gain[child] = value - obj_val;
+                learn(p, child, gain[child], score);
+            }
+            strong_evals++;
+        }
+
+        cost const product = max((cost)BRANCH_MIN_GAIN, gain[0]) *
+            max((cost)BRANCH_MIN_GAIN, gain[1]);
+        LOG_F(INFO,
+              "Candidate {%d,%d} (%Lf): gains %Lf and %Lf.",
+              u,
+              v,
+              score,
+              gain[0],
+              gain[1]);
+        if (product > best_product) {
+            best_product = product;
+            best = candidates[c];
+            best_bound[0] = bound[0];
+            best_bound[1] = bound[1];
+        }
+    }
+
+    cost estimate = obj_val;
+    if (BRANCH_SELECTION == selection::best_estimate) {
+        for (cost const x : x_s) {
+            estimate += min(x, 1 - x);
+        }
+    }
+
+    LOG_F(INFO, "Adding branch on %d and %d", best.u, best.v);
+    auto const sets = make_shared<const vector<column_id>>(indep_sets);
+    auto const fixed_sets = make_shared<const vector<column_id>>(fixed);
+    for (int child = 0; child < 2; child++) {
+        mod_type const t = child == 0 ? mod_type::conflict : mod_type::contract;
+        children.push_back(Branch::node {best_bound[child],
+                                         estimate,
+                                         created++,
+                                         path,
+                                         sets,
+                                         obj_val,
+                                         best.score,
+                                         fixed_sets});
+        children.back().path.push_back(Graph::mod {t, best.u, best.v});
+    }
 }
 
-vector<node_set> clean_sets(const Graph& g,
-                            const mod_type& t,
-                            const vector<node_set>& indep_sets,
-                            const node& u,
-                            const node& v)
+void Branch::log_stats() const
 {
-    vector<node_set> ret;
-    for (const node_set& set : indep_sets) {
-        auto found_u = set.find(u) != set.end();
-        auto found_v = set.find(v) != set.end();
+    LOG_F(INFO,
+          "Branching: %d nodes, %d strong branching evaluations, %d by "
+          "pseudo-costs.",
+          visited,
+          strong_evals,
+          pseudo_uses);
+}
+
+vector<column_id> clean_sets(const Graph& g,
+                             ColumnPool& pool,
+                             const mod_type& t,
+                             const vector<column_id>& indep_sets,
+                             const node& u,
+                             const node& v)
+{
+    vector<column_id> ret;
+    for (column_id const id : indep_sets) {
+        auto found_u = pool.contains(id, u);
+        auto found_v = pool.contains(id, v);
 
         if (t == mod_type::conflict and not(found_u and found_v)) {
-            ret.push_back(set);
+            ret.push_back(id);
         }
         if (t == mod_type::contract and not(found_u or found_v)) {
-            ret.push_back(set);
+            ret.push_back(id);
         }
     }
 
     // Make sure that all nodes are present in at least one set
     vector<bool> is_present = vector<bool>(g.get_n(), false);
-    for (node_set const& set : ret) {
-        for (node const x : set) {
+    for (column_id const id : ret) {
+        for (node const x : pool.get_members(id)) {
             is_present[x] = true;
         }
     }
     for_nodes(g, i) {
         if (not is_present[i]) {
-            ret.push_back({i});
+            ret.push_back(pool.insert({i}));
         }
     }
 
     return ret;
 }
 
-// TODO mudar conflict/contract para ser um marcador de estágio com uma
-// sequência: none -> conflict -> contract
+/*
+** Order of the heap: true if a is to be explored after b.
+*/
+static bool worse(const Branch::node& a, const Branch::node& b)
+{
+    cost const key_a =
+        BRANCH_SELECTION == Branch::selection::best_bound ? a.obj_val
+                                                          : a.estimate;
+    cost const key_b =
+        BRANCH_SELECTION == Branch::selection::best_bound ? b.obj_val
+                                                          : b.estimate;
+    if (abs(key_a - key_b) > EPS) {
+        return key_a > key_b;
+    }
+    if (a.path.size() != b.path.size()) {
+        return a.path.size() < b.path.size();
+    }
+    return a.order > b.order;
+}
+
+void replay(Graph& g,
+            vector<Graph::mod>& path,
+            const vector<Graph::mod>& target)
+{
+    size_t common = 0;
+    while (common < path.size() and common < target.size() and
+           path[common].t == target[common].t and
+           path[common].u == target[common].u and
+           path[common].v == target[common].v) {
+        common++;
+    }
 
-vector<node_set> Branch::next(Graph& g, const cost& upper_bound)
+    while (path.size() > common) {
+        g.undo(path.back().t, path.back().u, path.back().v);
+        path.pop_back();
+    }
+    for (size_t i = common; i < target.size(); i++) {
+        g.change(target[i].t, target[i].u, target[i].v);
+        path.push_back(target[i]);
+    }
+}
+
+vector<column_id> Branch::next(Graph& g,
+                               ColumnPool& pool,
+                               const cost& upper_bound,
+                               vector<column_id>& fixed)
 {
     LOG_SCOPE_FUNCTION(INFO);
-    LOG_F(INFO, "Stack size: %lu | Visited: %d", tree.size(), visited);
-
-    if (tree.empty()) {
+    has_taken = false;
+    if (time_out()) {
+        LOG_F(INFO,
+              "Out of time with %lu open nodes",
+              queue.size() + children.size());
         return {};
     }
-    Branch::node n = tree.top();
-
-    while (n.obj_val > upper_bound + EPS  // if it's worse then UB
-           or (n.conflict_done and n.contract_done))  // or has been completed
-    {
-        tree.pop();
+    LOG_F(INFO,
+          "Open nodes: %lu | Visited: %d",
+          queue.size() + children.size(),
+          visited);
 
-        // undo the last done
-        if (n.contract_done) {
-            g.undo(mod_type::contract, n.u, n.v);
-        } else if (n.conflict_done) {
-            g.undo(mod_type::conflict, n.u, n.v);
-        }
+    auto const pruned = [&upper_bound](const Branch::node& n)
+    { return ceil(n.obj_val) >= upper_bound; };
 
-        if (tree.empty()) {
-            LOG_F(INFO, "Stack is empty");
-            return {};
-        }
-        n = tree.top();
+    // a dive goes on with the conflict child of the last node, if any
+    Branch::node n;
+    bool const dive =
+        diving and not children.empty() and not pruned(children.front());
+    if (dive) {
+        n = std::move(children.front());
+        children.erase(children.begin());
     }
+    for (Branch::node& child : children) {
+        queue.push_back(std::move(child));
+        push_heap(queue.begin(), queue.end(), worse);
+    }
+    children.clear();
 
-    tree.pop();
+    if (not dive) {
+        do {
+            if (queue.empty()) {
+                LOG_F(INFO, "Tree is empty");
+                replay(g, path, {});
+                return {};
+            }
+            pop_heap(queue.begin(), queue.end(), worse);
+            n = std::move(queue.back());
+            queue.pop_back();
+        } while (pruned(n));
+        diving = BRANCH_DIVE_PERIOD > 0 and
+            ++selected % BRANCH_DIVE_PERIOD == 0;
+    }
 
     LOG_F(INFO,
-          "Node {%d,%d}: conf %d | cont %d (ub: %Lf)",
-          n.u,
-          n.v,
-          n.conflict_done,
-          n.contract_done,
-          n.obj_val);
+          "Node at depth %lu (bound %Lf, estimate %Lf)%s",
+          n.path.size(),
+          n.obj_val,
+          n.estimate,
+          diving ? ", diving" : "");
+
+    replay(g, path, n.path);
+    taken = n.obj_val;
+    has_taken = true;
+    last = n;
+    current = n.path.back();
+    current_score = n.score;
+    current_parent = n.parent_val;
+    auto const [t, u, v] = n.path.back();
+    LOG_F(INFO, "%s on %d <- %d", to_string(t).c_str(), u, v);
 
-    // If any mod has been done, it's time to undo it.
-    if (n.contract_done) {
-        // FIXME eu acho que isso nunca deve acontecer
-        g.undo(mod_type::contract, n.u, n.v);
-    } else if (n.conflict_done) {
-        g.undo(mod_type::conflict, n.u, n.v);
+    vector<column_id> ret = clean_sets(g, pool, t, *n.indep_sets, u, v);
+
+    // after a contraction, a set with u stands for one with v too: it is not
+    // the set fixed in the parent
+    fixed.clear();
+    for (column_id const id : *n.fixed) {
+        if (t == mod_type::conflict or
+            not(pool.contains(id, u) or pool.contains(id, v))) {
+            fixed.push_back(id);
+        }
     }
+    DCHECK_F(check_indep_sets(g, pool.get_sets(ret)), "not independent set");
 
-    mod_type t = mod_type::conflict;
-    if (n.conflict_done) {
-        t = mod_type::contract;
-        n.contract_done = true;
-    } else {
-        t = mod_type::conflict;
-        n.conflict_done = true;
+    visited++;
+    return ret;
+}
+
+vector<const Branch::node*> Branch::get_open() const
+{
+    vector<const Branch::node*> open = {};
+    for (const Branch::node& n : queue) {
+        open.push_back(&n);
     }
+    for (const Branch::node& n : children) {
+        open.push_back(&n);
+    }
+    return open;
+}
 
-    LOG_F(INFO, "%s on %d <- %d", to_string(t).c_str(), n.u, n.v);
-    g.change(t, n.u, n.v);
-    tree.push(n);
+void Branch::resume(vector<Branch::node>&& open)
+{
+    queue = std::move(open);
+    for (const Branch::node& n : queue) {
+        created = max(created, n.order + 1);
+    }
+    make_heap(queue.begin(), queue.end(), worse);
+}
 
-    vector<node_set> ret = clean_sets(g, t, n.indep_sets, n.u, n.v);
-    DCHECK_F(check_indep_sets(g, ret), "not independent set");
+bool Branch::reopen(const cost& bound)
+{
+    if (not has_taken) {
+        return false;
+    }
+    has_taken = false;
+    last.obj_val = max(last.obj_val, bound);
+    queue.push_back(std::move(last));
+    push_heap(queue.begin(), queue.end(), worse);
+    return true;
+}
 
-    visited++;
-    return ret;
+cost Branch::get_lower_bound(const cost& upper_bound) const
+{
+    cost bound = has_taken ? min(upper_bound, taken) : upper_bound;
+    for (const Branch::node* n : get_open()) {
+        bound = min(bound, n->obj_val);
+    }
+    return bound;
 }
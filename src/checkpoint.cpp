@@ -0,0 +1,239 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#include "../incl/checkpoint.hpp"
+
+namespace
+{
+const char MAGIC[8] = {'M', 'E', 'S', 'T', 'C', 'K', 'P', '2'};
+
+// Buffer of the checkpoint, with each value in the bytes of the machine
+class writer
+{
+  public:
+    template<typename T>
+    void put(const T& value)
+    {
+        auto const* p = reinterpret_cast<const char*>(&value);
+        buf.insert(buf.end(), p, p + sizeof(T));
+    }
+
+    template<typename Set>
+    void put_set(const Set& set)
+    {
+        put((uint32_t)set.size());
+        for (node const u : set) {
+            put((uint16_t)u);
+        }
+    }
+
+    vector<char> buf;
+};
+
+class reader
+{
+  public:
+    explicit reader(const string& file)
+        : in(file, ios::binary)
+    {
+        CHECK_F(in.good(), "Cannot read the checkpoint %s.", file.c_str());
+    }
+
+    template<typename T>
+    T get()
+    {
+        T value;
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+        CHECK_F(in.good(), "The checkpoint is truncated.");
+        return value;
+    }
+
+    node_set get_set()
+    {
+        node_set set = {};
+        for (uint32_t k = get<uint32_t>(); k > 0; k--) {
+            set.insert(get<uint16_t>());
+        }
+        return set;
+    }
+
+  private:
+    ifstream in;
+};
+}  // namespace
+
+Checkpoint::Checkpoint(string file)
+    : file(std::move(file))
+    , last(chrono::steady_clock::now())
+{
+}
+
+Checkpoint::~Checkpoint()
+{
+    if (writing.valid()) {
+        writing.wait();
+    }
+}
+
+void Checkpoint::offer(const Graph& g,
+                       const ColumnPool& pool,
+                       const Branch& tree,
+                       const cost& upper_bound,
+                       const vector<node_set>& coloring)
+{
+    auto const now = chrono::steady_clock::now();
+    if (file.empty() or
+        chrono::duration<double>(now - last).count() < CHECKPOINT_PERIOD or
+        (writing.valid() and
+         writing.wait_for(chrono::seconds(0)) != future_status::ready)) {
+        return;
+    }
+    save(g, pool, tree, upper_bound, coloring);
+}
+
+void Checkpoint::save(const Graph& g,
+                      const ColumnPool& pool,
+                      const Branch& tree,
+                      const cost& upper_bound,
+                      const vector<node_set>& coloring)
+{
+    if (file.empty()) {
+        return;
+    }
+    if (writing.valid()) {
+        writing.wait();
+    }
+    last = chrono::steady_clock::now();
+
+    writer w;
+    w.buf.insert(w.buf.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    w.put((uint32_t)g.get_n());
+    w.put((double)upper_bound);
+    w.put((uint32_t)coloring.size());
+    for (const node_set& set : coloring) {
+        w.put_set(set);
+    }
+    w.put((uint32_t)pool.size());
+    for (column_id id = 0; id < pool.size(); id++) {
+        w.put_set(pool.get_members(id));
+    }
+
+    // the children of a node share the lists of the sets of their parent
+    // and of the sets fixed in it
+    vector<const Branch::node*> const open = tree.get_open();
+    map<const vector<column_id>*, uint32_t> lists;
+    for (const Branch::node* n : open) {
+        lists.emplace(n->indep_sets.get(), lists.size());
+        lists.emplace(n->fixed.get(), lists.size());
+    }
+    vector<const vector<column_id>*> by_index(lists.size());
+    for (auto const [list, index] : lists) {
+        by_index[index] = list;
+    }
+    w.put((uint32_t)by_index.size());
+    for (const vector<column_id>* list : by_index) {
+        w.put((uint32_t)list->size());
+        for (column_id const id : *list) {
+            w.put((uint32_t)id);
+        }
+    }
+
+    w.put((uint32_t)open.size());
+    for (const Branch::node* n : open) {
+        w.put((double)n->obj_val);
+        w.put((double)n->estimate);
+        w.put((double)n->parent_val);
+        w.put((double)n->score);
+        w.put((uint64_t)n->order);
+        w.put(lists[n->indep_sets.get()]);
+        w.put(lists[n->fixed.get()]);
+        w.put((uint32_t)n->path.size());
+        for (auto const [t, u, v] : n->path) {
+            w.put((uint8_t)(t == mod_type::contract));
+            w.put((uint16_t)u);
+            w.put((uint16_t)v);
+        }
+    }
+
+    LOG_F(INFO,
+          "Checkpoint of %lu sets and %lu open nodes (%lu bytes).",
+          pool.size(),
+          open.size(),
+          w.buf.size());
+    writing = async(launch::async,
+                    [buf = std::move(w.buf), file = file]()
+                    {
+                        string const tmp = file + ".tmp";
+                        ofstream out(tmp, ios::binary | ios::trunc);
+                        out.write(buf.data(), buf.size());
+                        out.close();
+                        if (not out.good() or
+                            rename(tmp.c_str(), file.c_str()) != 0) {
+                            LOG_F(ERROR,
+                                  "Cannot write the checkpoint %s.",
+                                  file.c_str());
+                        }
+                    });
+}
+
+checkpoint_state Checkpoint::load(const string& file, const Graph& g)
+{
+    LOG_SCOPE_F(INFO, "Loading checkpoint %s.", file.c_str());
+    reader r(file);
+    char magic[sizeof(MAGIC)];
+    for (char& c : magic) {
+        c = r.get<char>();
+    }
+    CHECK_F(memcmp(magic, MAGIC, sizeof(MAGIC)) == 0,
+            "%s is not a checkpoint.",
+            file.c_str());
+    CHECK_F(r.get<uint32_t>() == g.get_n(),
+            "The checkpoint is of another instance.");
+
+    checkpoint_state s;
+    s.upper_bound = r.get<double>();
+    s.coloring.resize(r.get<uint32_t>());
+    for (node_set& set : s.coloring) {
+        set = r.get_set();
+    }
+    s.sets.resize(r.get<uint32_t>());
+    for (node_set& set : s.sets) {
+        set = r.get_set();
+    }
+
+    vector<shared_ptr<const vector<column_id>>> lists(r.get<uint32_t>());
+    for (auto& list : lists) {
+        vector<column_id> ids(r.get<uint32_t>());
+        for (column_id& id : ids) {
+            id = r.get<uint32_t>();
+        }
+        list = make_shared<const vector<column_id>>(std::move(ids));
+    }
+
+    s.open.resize(r.get<uint32_t>());
+    for (Branch::node& n : s.open) {
+        n.obj_val = r.get<double>();
+        n.estimate = r.get<double>();
+        n.parent_val = r.get<double>();
+        n.score = r.get<double>();
+        n.order = r.get<uint64_t>();
+        n.indep_sets = lists.at(r.get<uint32_t>());
+        n.fixed = lists.at(r.get<uint32_t>());
+        n.path.resize(r.get<uint32_t>());
+        for (Graph::mod& m : n.path) {
+            m.t = r.get<uint8_t>() ? mod_type::contract : mod_type::conflict;
+            m.u = r.get<uint16_t>();
+            m.v = r.get<uint16_t>();
+        }
+    }
+
+    LOG_F(INFO,
+          "%lu sets, %lu open nodes and a coloring with %Lf colors.",
+          s.sets.size(),
+          s.open.size(),
+          s.upper_bound);
+    return s;
+}
@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../incl/distributed.hpp"
+
+#include "../incl/search.hpp"
+
+namespace
+{
+/*
+** Connection with the other side, with one message written after the other
+** as text. Each message is only sent once the one before it is answered, so
+** a readable socket always holds a whole message. A read that fails, because
+** the other side is gone or sent garbage, gives 0 or nothing and marks the
+** channel as bad.
+*/
+class channel
+{
+  public:
+    explicit channel(int fd)
+        : in(fdopen(fd, "r"))
+        , out(fdopen(dup(fd), "w"))
+    {
+        CHECK_F(in != nullptr and out != nullptr, "Cannot open the socket.");
+    }
+    channel(const channel&) = delete;
+    channel& operator=(const channel&) = delete;
+    ~channel()
+    {
+        fclose(in);
+        fclose(out);
+    }
+
+    int get_fd() const { return fileno(in); }
+    bool good() const { return not bad and not ferror(out); }
+    void flush() { fflush(out); }
+
+    void put_word(const char* word) { fprintf(out, "%s\n", word); }
+    string get_word()
+    {
+        char word[16];
+        if (fscanf(in, "%15s", word) != 1) {
+            bad = true;
+            return "";
+        }
+        return word;
+    }
+
+    void put_cost(const cost& c) { fprintf(out, "%La\n", c); }
+    cost get_cost()
+    {
+        cost c = 0;
+        bad = bad or fscanf(in, "%La", &c) != 1;
+        return c;
+    }
+
+    void put_size(size_t s) { fprintf(out, "%zu\n", s); }
+    size_t get_size()
+    {
+        size_t s = 0;
+        bad = bad or fscanf(in, "%zu", &s) != 1;
+        return bad ? 0 : s;
+    }
+
+    void put_sets(const vector<node_set>& sets)
+    {
+        put_size(sets.size());
+        for (const node_set& set : sets) {
+            fprintf(out, "%zu", set.size());
+            for (node const u : set) {
+                fprintf(out, " %hu", u);
+            }
+            fprintf(out, "\n");
+        }
+    }
+    vector<node_set> get_sets()
+    {
+        vector<node_set> sets(get_size());
+        for (node_set& set : sets) {
+            for (size_t k = get_size(); k > 0; k--) {
+                node u = 0;
+                bad = bad or fscanf(in, "%hu", &u) != 1;
+                set.insert(u);
+            }
+        }
+        return sets;
+    }
+
+    void put_node(const open_node& n)
+    {
+        put_cost(n.obj_val);
+        put_size(n.path.size());
+        for (auto const [t, u, v] : n.path) {
+            fprintf(out, "%d %hu %hu\n", t == mod_type::contract, u, v);
+        }
+        put_sets(*n.indep_sets);
+    }
+    open_node get_node()
+    {
+        open_node n = {get_cost(), vector<Graph::mod>(get_size()), {}};
+        for (Graph::mod& m : n.path) {
+            int contract = 0;
+            bad = bad or fscanf(in, "%d %hu %hu", &contract, &m.u, &m.v) != 3;
+            m.t = contract ? mod_type::contract : mod_type::conflict;
+        }
+        n.indep_sets = make_shared<const vector<node_set>>(get_sets());
+        return n;
+    }
+
+  private:
+    FILE* in;
+    FILE* out;
+    bool bad = false;
+};
+
+/*
+** Socket address: host:port for TCP, anything else is the path of a Unix
+** socket. With no host, TCP is on the loopback only: the protocol has no
+** authentication, so remote workers need an explicit host to listen on.
+** Returns the family, filling addr and len.
+*/
+int resolve(const string& address, sockaddr_storage& addr, socklen_t& len)
+{
+    memset(&addr, 0, sizeof(addr));
+    size_t const colon = address.rfind(':');
+    if (colon == string::npos) {
+        auto* un = reinterpret_cast<sockaddr_un*>(&addr);
+        CHECK_F(address.size() < sizeof(un->sun_path),
+                "Socket path %s is too long.",
+                address.c_str());
+        un->sun_family = AF_UNIX;
+        strcpy(un->sun_path, address.c_str());
+        len = sizeof(sockaddr_un);
+        return AF_UNIX;
+    }
+
+    string const host = address.substr(0, colon);
+    string const port = address.substr(colon + 1);
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    CHECK_F(getaddrinfo(host.empty() ? nullptr : host.c_str(),
+                        port.c_str(),
+                        &hints,
+                        &res) == 0,
+            "Cannot resolve %s.",
+            address.c_str());
+    memcpy(&addr, res->ai_addr, res->ai_addrlen);
+    len = res->ai_addrlen;
+    freeaddrinfo(res);
+    return AF_INET;
+}
+
+int listen_on(const string& address)
+{
+    sockaddr_storage addr;
+    socklen_t len = 0;
+    int const family = resolve(address, addr, len);
+    if (family == AF_UNIX) {
+        unlink(address.c_str());
+    }
+    int const fd = socket(family, SOCK_STREAM, 0);
+    int const yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    // only our own user gets to connect to a Unix socket
+    CHECK_F(fd >= 0 and bind(fd, (sockaddr*)&addr, len) == 0 and
+                (family != AF_UNIX or chmod(address.c_str(), 0600) == 0) and
+                listen(fd, SOMAXCONN) == 0,
+            "Cannot listen on %s: %s.",
+            address.c_str(),
+            strerror(errno));
+    return fd;
+}
+
+int connect_to(const string& address)
+{
+    sockaddr_storage addr;
+    socklen_t len = 0;
+    int const family = resolve(address, addr, len);
+    int const fd = socket(family, SOCK_STREAM, 0);
+    CHECK_F(fd >= 0 and connect(fd, (sockaddr*)&addr, len) == 0,
+            "Cannot connect to %s: %s.",
+            address.c_str(),
+            strerror(errno));
+    return fd;
+}
+
+// Heap of the open nodes: best bound first, then the deepest
+bool worse(const open_node& a, const open_node& b)
+{
+    if (abs(a.obj_val - b.obj_val) > EPS) {
+        return a.obj_val > b.obj_val;
+    }
+    return a.path.size() < b.path.size();
+}
+}  // namespace
+
+cost distributed_search(const Graph& orig,
+                        const vector<node_set>& initial_sets,
+                        cost upper_bound,
+                        const string& instance,
+                        cost& lower_bound)
+{
+    LOG_SCOPE_F(INFO, "Distributed search.");
+    // a worker that is gone fails the writes to it instead of killing us
+    signal(SIGPIPE, SIG_IGN);
+    bool const spawn = config.listen.empty();
+    string const address = spawn
+        ? "/tmp/mest." + to_string(getpid()) + ".sock"
+        : config.listen;
+    int const server = listen_on(address);
+
+    vector<pid_t> spawned = {};
+    for (unsigned int i = 0; spawn and i < config.workers; i++) {
+        pid_t const pid = fork();
+        CHECK_F(pid >= 0, "Cannot start a worker: %s.", strerror(errno));
+        if (pid == 0) {
+            string const threads = to_string(config.threads);
+            string const time_limit = to_string(config.time_limit);
+            execl("/proc/self/exe",
+                  "mest-worker",
+                  instance.c_str(),
+                  "--connect",
+                  address.c_str(),
+                  "--threads",
+                  threads.c_str(),
+                  "--time-limit",
+                  time_limit.c_str(),
+                  nullptr);
+            _exit(1);
+        }
+        spawned.push_back(pid);
+    }
+
+    LOG_F(INFO,
+          "Waiting for %u workers on %s.",
+          config.workers,
+          address.c_str());
+    vector<unique_ptr<channel>> workers = {};
+    while (workers.size() < config.workers) {
+        int const fd = accept(server, nullptr, nullptr);
+        CHECK_F(fd >= 0, "Cannot accept a worker: %s.", strerror(errno));
+        workers.push_back(make_unique<channel>(fd));
+    }
+    close(server);
+    if (spawn) {
+        unlink(address.c_str());
+    }
+
+    size_t const n_workers = workers.size();
+    vector<open_node> frontier = {
+        {0, {}, make_shared<const vector<node_set>>(initial_sets)}};
+    vector<vector<node_set>> pending(n_workers);  // sets to forward
+    vector<bool> busy(n_workers, false);
+    vector<open_node> assigned(n_workers);  // node of each busy worker
+    size_t handed = 0;
+
+    // a worker that is gone is closed, and its node goes back to the frontier
+    auto const drop = [&](size_t w) {
+        LOG_F(ERROR, "Worker %zu is gone, its node goes back.", w);
+        workers[w].reset();
+        busy[w] = false;
+        frontier.push_back(std::move(assigned[w]));
+        push_heap(frontier.begin(), frontier.end(), worse);
+        CHECK_F(any_of(workers.begin(),
+                       workers.end(),
+                       [](const unique_ptr<channel>& c) { return c != nullptr; }),
+                "Every worker is gone.");
+    };
+
+    while (true) {
+        for (size_t w = 0; w < n_workers; w++) {
+            while (workers[w] and not busy[w] and not frontier.empty() and
+                   not time_out()) {
+                pop_heap(frontier.begin(), frontier.end(), worse);
+                assigned[w] = std::move(frontier.back());
+                frontier.pop_back();
+                if (ceil(assigned[w].obj_val) >= upper_bound) {
+                    continue;
+                }
+                workers[w]->put_word("node");
+                workers[w]->put_cost(upper_bound);
+                workers[w]->put_node(assigned[w]);
+                workers[w]->put_sets(pending[w]);
+                workers[w]->flush();
+                pending[w].clear();
+                busy[w] = true;
+                handed++;
+                if (not workers[w]->good()) {
+                    drop(w);
+                }
+            }
+        }
+        if (none_of(busy.begin(), busy.end(), [](bool b) { return b; })) {
+            break;
+        }
+
+        vector<pollfd> fds = {};
+        for (size_t w = 0; w < n_workers; w++) {
+            fds.push_back({busy[w] ? workers[w]->get_fd() : -1, POLLIN, 0});
+        }
+        CHECK_F(poll(fds.data(), fds.size(), -1) > 0,
+                "Cannot wait for the workers: %s.",
+                strerror(errno));
+
+        for (size_t w = 0; w < n_workers; w++) {
+            if (fds[w].revents == 0) {
+                continue;
+            }
+            // the whole answer is read before any of it is used
+            channel& c = *workers[w];
+            bool const result = c.get_word() == "result";
+            cost const colors = c.get_cost();
+            vector<node_set> const coloring = c.get_sets();
+            vector<node_set> const columns = c.get_sets();
+            vector<open_node> subtree(c.get_size());
+            for (open_node& n : subtree) {
+                n = c.get_node();
+            }
+            if (not result or not c.good()) {
+                drop(w);
+                continue;
+            }
+            busy[w] = false;
+
+            if (colors > 0 and colors < upper_bound) {
+                upper_bound = colors;
+                log_bound("UB", upper_bound);
+                log_solution(
+                    orig, coloring, vector<cost>(coloring.size(), 1), colors);
+            }
+
+            for (size_t other = 0; other < n_workers; other++) {
+                if (other != w and workers[other]) {
+                    pending[other].insert(
+                        pending[other].end(), columns.begin(), columns.end());
+                }
+            }
+
+            for (open_node& n : subtree) {
+                frontier.push_back(std::move(n));
+                push_heap(frontier.begin(), frontier.end(), worse);
+            }
+        }
+        LOG_F(INFO,
+              "Open nodes: %lu | Handed out: %lu | UB: %Lf",
+              frontier.size(),
+              handed,
+              upper_bound);
+    }
+
+    // the workers gave back every node they were handed, so once out of time
+    // the frontier holds all the open ones
+    lower_bound = upper_bound;
+    for (const open_node& n : frontier) {
+        lower_bound = min(lower_bound, n.obj_val);
+    }
+
+    for (unique_ptr<channel>& c : workers) {
+        if (c) {
+            c->put_word("stop");
+            c->flush();
+        }
+    }
+    workers.clear();
+    for (pid_t const pid : spawned) {
+        waitpid(pid, nullptr, 0);
+    }
+    return upper_bound;
+}
+
+void distributed_worker(const Graph& g)
+{
+    LOG_SCOPE_F(INFO, "Distributed worker.");
+    channel c(connect_to(config.connect));
+    TreeWorker worker(g);
+
+    vector<node_set> coloring;
+    vector<open_node> children;
+    while (c.get_word() == "node") {
+        cost upper_bound = c.get_cost();
+        vector<open_node> subtree = {c.get_node()};
+        vector<node_set> const columns = c.get_sets();
+        CHECK_F(c.good(), "Bad message.");
+        worker.add_columns(columns);
+
+        cost best = 0;
+        vector<node_set> best_coloring = {};
+        for (int k = 0;
+             k < DISTRIBUTED_BATCH and not subtree.empty() and not time_out();
+             k++) {
+            open_node const n = std::move(subtree.back());
+            subtree.pop_back();
+            cost const value =
+                worker.process(n, upper_bound, coloring, children);
+            if (value > 0 and value < upper_bound) {
+                upper_bound = best = value;
+                best_coloring = coloring;
+            }
+            // the last one pushed is taken first: conflict
+            for (open_node& child : children) {
+                subtree.push_back(std::move(child));
+            }
+            children.clear();
+        }
+        auto last = remove_if(subtree.begin(),
+                              subtree.end(),
+                              [&upper_bound](const open_node& n)
+                              { return ceil(n.obj_val) >= upper_bound; });
+        subtree.erase(last, subtree.end());
+
+        c.put_word("result");
+        c.put_cost(best);
+        c.put_sets(best_coloring);
+        c.put_sets(worker.new_columns());
+        c.put_size(subtree.size());
+        for (const open_node& n : subtree) {
+            c.put_node(n);
+        }
+        c.flush();
+    }
+    worker.log_stats();
+}
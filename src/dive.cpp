@@ -0,0 +1,71 @@
+#include <cmath>
+
+#include "../incl/branch.hpp"
+#include "../incl/heuristic.hpp"
+
+cost dive(Graph& g,
+          ColumnPool& pool,
+          Solver& solver,
+          vector<column_id> indep_sets,
+          vector<cost> x_s,
+          const cost& upper_bound,
+          double deadline,
+          vector<node_set>& coloring)
+{
+    LOG_SCOPE_FUNCTION(INFO);
+    vector<Graph::mod> fixed = {};
+    cost value = 0;
+    while (true) {
+        if (integral(x_s)) {
+            coloring.clear();
+            for (size_t i = 0; i < indep_sets.size(); i++) {
+                value += round(x_s[i]);
+                if (x_s[i] >= 1 - EPS) {
+                    coloring.push_back(pool.get_set(indep_sets[i]));
+                }
+            }
+            g.apply_changes_to_sol(coloring);
+            break;
+        }
+
+        // the set closest to be in the coloring, ties to the first. A single
+        // node contracts nothing, so fixing it would leave the LP as it was.
+        size_t best = indep_sets.size();
+        for (size_t i = 0; i < indep_sets.size(); i++) {
+            if (x_s[i] > EPS and x_s[i] < 1 - EPS and
+                pool.get_set(indep_sets[i]).size() > 1 and
+                (best == indep_sets.size() or x_s[i] > x_s[best])) {
+                best = i;
+            }
+        }
+        if (best == indep_sets.size()) {
+            LOG_F(INFO, "Dive stuck after %lu changes.", fixed.size());
+            break;
+        }
+        node_set const set = pool.get_set(indep_sets[best]);
+        node const u = *set.begin();
+        for (node const v : set) {
+            if (v != u) {
+                g.change(mod_type::contract, u, v);
+                fixed.push_back(Graph::mod {mod_type::contract, u, v});
+                indep_sets =
+                    clean_sets(g, pool, mod_type::contract, indep_sets, u, v);
+            }
+        }
+
+        cost const sol =
+            solver.solve(g, indep_sets, x_s, upper_bound, DIVE_ROUNDS);
+        if (ceil(sol - EPS) >= upper_bound or elapsed() >= deadline or
+            time_out()) {
+            LOG_F(INFO, "Dive cut at %Lf after %lu changes.", sol, fixed.size());
+            break;
+        }
+    }
+
+    while (not fixed.empty()) {
+        g.undo(fixed.back().t, fixed.back().u, fixed.back().v);
+        fixed.pop_back();
+    }
+    LOG_F(INFO, "Dive found %Lf colors.", value);
+    return value < upper_bound ? value : 0;
+}
@@ -370,7 +370,7 @@ void Graph::apply_changes_to_sol(vector<node_set>& indep_sets) const
         if (t == mod_type::conflict) {
             continue;
         }
-        for (auto set : indep_sets) {
+        for (node_set& set : indep_sets) {
             if (set.find(u) != set.end()) {
                 set.insert(v);
                 break;
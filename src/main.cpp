@@ -1,12 +1,19 @@
+#include <algorithm>
 #include <cmath>
-#include <map>
+#include <cstring>
 #include <string>
 #include <vector>
 
+#include <unistd.h>
+
 #include "../incl/branch.hpp"
+#include "../incl/checkpoint.hpp"
+#include "../incl/distributed.hpp"
 #include "../incl/graph.hpp"
 #include "../incl/heuristic.hpp"
+#include "../incl/pool.hpp"
 #include "../incl/pricing.hpp"
+#include "../incl/search.hpp"
 #include "../incl/solver.hpp"
 #include "../incl/utils.hpp"
 
@@ -18,46 +25,222 @@ void config_logging(int argc, char** argv)
     loguru::g_stderr_verbosity = 0;
     loguru::g_flush_interval_ms = 100;
     loguru::init(argc, argv);
+
+    // each worker process of a distributed search has its own log
+    string file = "log.log";
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--connect") == 0) {
+            file = "log." + to_string(getpid()) + ".log";
+        }
+    }
     loguru::add_file(
-        "log.log", loguru::FileMode::Truncate, loguru::Verbosity_MAX);
+        file.c_str(), loguru::FileMode::Truncate, loguru::Verbosity_MAX);
+}
+
+// Final bounds of a search stopped by the time limit
+void log_gap(cost upper_bound, cost lower_bound)
+{
+    log_bound("LB", lower_bound);
+    LOG_F(WARNING,
+          "Out of time: UB %Lf, LB %Lf, gap %.2Lf%%.",
+          upper_bound,
+          lower_bound,
+          100 * (upper_bound - lower_bound) / upper_bound);
 }
 
 int main(int argc, char** argv)
 {
     // Logging config
     config_logging(argc, argv);
+    parse_args(argc, argv);
 
     // Read the instance and create the graph
     Graph* g = read_dimacs_instance(argv[1]);
 
-    vector<node_set> indep_sets;
-    cost upper_bound = heuristic(*g, indep_sets);
-    enrich(*g, indep_sets);
-    // TODO quando a instância for densa, usar clique (mas isso é raro)
-    // TODO usar independance number para achar um lb
+    if (not config.connect.empty()) {
+        distributed_worker(*g);
+        delete g;
+        return 0;
+    }
 
-    Solver solver = Solver();
+    // every node refers to its sets by their ids in the pool
+    ColumnPool pool = ColumnPool(g->get_n());
+    vector<column_id> indep_sets;
+    vector<column_id> fixed;  // sets fixed to 0 in the node
+    vector<node_set> coloring;
+    cost upper_bound = 0;
     Branch tree;
 
+    if (not config.resume.empty()) {
+        checkpoint_state s = Checkpoint::load(config.resume, *g);
+        upper_bound = s.upper_bound;
+        coloring = std::move(s.coloring);
+        for (const node_set& set : s.sets) {
+            CHECK_F(pool.insert(set) + 1 == pool.size(),
+                    "Repeated set in the checkpoint.");
+        }
+        tree.resume(std::move(s.open));
+        indep_sets = tree.next(*g, pool, upper_bound, fixed);
+    } else {
+        vector<node_set> initial_sets;
+        upper_bound = heuristic(*g, initial_sets);
+        log_bound("UB", upper_bound);
+        coloring = initial_sets;
+        enrich(*g, initial_sets);
+        // TODO quando a instância for densa, usar clique (mas isso é raro)
+        // TODO usar independance number para achar um lb
+
+        if (config.workers > 0) {
+            cost lower_bound = 0;
+            upper_bound = distributed_search(
+                *g, initial_sets, upper_bound, argv[1], lower_bound);
+            if (time_out()) {
+                log_gap(upper_bound, ceil(lower_bound - EPS));
+            }
+            LOG_F(WARNING, "Solved with: %Lf", upper_bound);
+            delete g;
+            return 0;
+        }
+
+        // in reproducible mode the tree is explored by a single worker
+        if (config.tree_threads > 1 and not config.reproducible) {
+            cost lower_bound = 0;
+            upper_bound =
+                parallel_search(*g, initial_sets, upper_bound, lower_bound);
+            if (time_out()) {
+                log_gap(upper_bound, ceil(lower_bound - EPS));
+            }
+            LOG_F(WARNING, "Solved with: %Lf", upper_bound);
+            delete g;
+            return 0;
+        }
+
+        for (const node_set& set : initial_sets) {
+            indep_sets.push_back(pool.insert(set));
+        }
+        // enrich may extend two sets to the same one
+        sort(indep_sets.begin(), indep_sets.end());
+        indep_sets.erase(unique(indep_sets.begin(), indep_sets.end()),
+                         indep_sets.end());
+    }
+
+    Solver solver = Solver(pool);
+    Checkpoint checkpoint(config.checkpoint);
+    cost lower_bound = 0;
+    cost cut_bound = upper_bound;  // of the node cut by the time limit
+
+    // a dive that finds nothing doubles the wait for the next one
+    int solved = 0;
+    int next_dive = 0;
+    int dive_period = DIVE_PERIOD;
+    double dive_time = 0;
+
+    // a resumed search starts below the root
+    solve_type type =
+        config.resume.empty() ? solve_type::root : solve_type::node;
     while (!indep_sets.empty()) {
-        map<node_set, cost> x_s;
+        vector<cost> x_s;
 
-        cost const sol = solver.solve(*g, indep_sets, x_s);
+        // a column generation stopped early may not reach the bound the
+        // parent already proved
+        cost const sol = max(
+            tree.get_taken(),
+            solver.solve(*g, indep_sets, x_s, upper_bound, 0, &fixed, type));
+        type = solve_type::node;
         LOG_F(INFO, "Solved with value %Lf", sol);
 
-        if (integral(x_s) and sol + EPS < upper_bound) {
-            upper_bound = sol;
-            log_solution(*g, indep_sets, x_s, sol);
+        // the bound may be below the value of the solution when the column
+        // generation stops early. An LP cut by the time limit has no solution.
+        if (not time_out() and integral(x_s)) {
+            cost value = 0;
+            for (cost const x : x_s) {
+                value += round(x);
+            }
+            if (value + EPS < upper_bound) {
+                upper_bound = value;
+                log_bound("UB", upper_bound);
+                log_solution(*g, pool.get_sets(indep_sets), x_s, value);
+
+                coloring.clear();
+                for (size_t i = 0; i < indep_sets.size(); i++) {
+                    if (x_s[i] >= 1 - EPS) {
+                        coloring.push_back(pool.get_set(indep_sets[i]));
+                    }
+                }
+                g->apply_changes_to_sol(coloring);
+            }
+        }
+
+        // a node cut by the time limit stays open, with the bound it reached
+        if (time_out()) {
+            cut_bound = sol;
+            break;
         }
 
+        if (DIVE_PERIOD > 0 and solved++ >= next_dive and
+            ceil(sol - EPS) < upper_bound and not integral(x_s) and
+            dive_time <= DIVE_TIME_SHARE * elapsed()) {
+            double const start = elapsed();
+            double const deadline =
+                start + DIVE_TIME_SHARE * (config.time_limit - start);
+            vector<node_set> dived;
+            cost const value = dive(*g,
+                                    pool,
+                                    solver,
+                                    indep_sets,
+                                    x_s,
+                                    upper_bound,
+                                    deadline,
+                                    dived);
+            if (value > 0) {
+                upper_bound = value;
+                log_bound("UB", upper_bound);
+                log_solution(
+                    *g, dived, vector<cost>(dived.size(), 1), upper_bound);
+                coloring = std::move(dived);
+                dive_period = DIVE_PERIOD;
+            } else {
+                dive_period *= 2;
+            }
+            next_dive = solved + dive_period;
+            dive_time += elapsed() - start;
+        }
         if (ceil(sol) < upper_bound) {
-            tree.branch(*g, indep_sets, x_s, sol);
+            tree.branch(
+                *g, pool, solver, indep_sets, x_s, sol, upper_bound, fixed);
         }
+        checkpoint.offer(*g, pool, tree, upper_bound, coloring);
+
+        indep_sets = tree.next(*g, pool, upper_bound, fixed);
 
-        indep_sets = tree.next(*g, upper_bound);
+        // the bounds of the open nodes only rise as the search goes on
+        cost const bound = ceil(tree.get_lower_bound(upper_bound) - EPS);
+        if (bound > lower_bound) {
+            lower_bound = bound;
+            log_bound("LB", lower_bound);
+        }
     }
 
+    if (time_out()) {
+        // the node cut by the time limit is the one last taken, and its bound
+        // is at least the one of its parent, so it replaces it
+        cost bound = min(cut_bound, upper_bound);
+        for (const Branch::node* n : tree.get_open()) {
+            bound = min(bound, n->obj_val);
+        }
+        lower_bound = max(lower_bound, ceil(bound - EPS));
+
+        // a root cut by the time limit leaves nothing to resume from
+        if (tree.reopen(cut_bound) or not tree.get_open().empty()) {
+            checkpoint.save(*g, pool, tree, upper_bound, coloring);
+        }
+        log_gap(upper_bound, lower_bound);
+    } else {
+        checkpoint.save(*g, pool, tree, upper_bound, coloring);
+    }
     LOG_F(WARNING, "Solved with: %Lf", upper_bound);
+    solver.log_stats();
+    tree.log_stats();
 
     delete g;
 
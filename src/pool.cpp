@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cstring>
+
+#include "../incl/pool.hpp"
+
+#include "../incl/utils.hpp"
+
+static uint64_t hash_words(const uint64_t* w, size_t words)
+{
+    // splitmix64 finalizer over the words, as node_set_hash
+    uint64_t h = words;
+    for (size_t i = 0; i < words; i++) {
+        h += 0x9e3779b97f4a7c15ULL + w[i];
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+    }
+    return h;
+}
+
+/*
+** Weighted sums of the POOL_LANES sets of a block. Each lane has its own sum,
+** so no addition is reordered and the compiler can add all lanes at once.
+*/
+static void block_sums(const double* w,
+                       const unsigned* members,
+                       size_t length,
+                       double* sum)
+{
+    double acc[POOL_LANES] = {};
+    for (size_t k = 0; k < length; k++) {
+        const unsigned* m = members + k * POOL_LANES;
+        for (size_t j = 0; j < POOL_LANES; j++) {
+            acc[j] += w[m[j]];
+        }
+    }
+    copy(acc, acc + POOL_LANES, sum);
+}
+
+ColumnPool::ColumnPool(node n)
+    : n(n)
+    , words((n + 63) / 64)
+    , offsets({0})
+{
+}
+
+column_id ColumnPool::insert(const node_set& set)
+{
+    vector<uint64_t> w(words, 0);
+    for (node const u : set) {
+        w[u / 64] |= 1ULL << (u % 64);
+    }
+    uint64_t const h = hash_words(w.data(), words);
+    auto [first, last] = index.equal_range(h);
+    for (auto it = first; it != last; ++it) {
+        if (memcmp(get_bits(it->second), w.data(), words * 8) == 0) {
+            return it->second;
+        }
+    }
+
+    size_t const id = size();
+    bits.insert(bits.end(), w.begin(), w.end());
+    hashes.push_back(h);
+    index.emplace(h, id);
+    nodes.insert(nodes.end(), set.begin(), set.end());
+    offsets.push_back(nodes.size());
+
+    if (id % POOL_LANES == 0) {
+        blocks.push_back({0, {}});
+    }
+    block& b = blocks.back();
+    size_t const lane = id % POOL_LANES;
+    if (set.size() > b.length) {
+        // make room for the new set, padding the others with n
+        vector<unsigned> members((size_t)set.size() * POOL_LANES, n);
+        copy(b.members.begin(), b.members.end(), members.begin());
+        b.members = std::move(members);
+        b.length = set.size();
+    }
+    size_t k = 0;
+    for (node const u : set) {
+        b.members[k * POOL_LANES + lane] = u;
+        k++;
+    }
+    for (; k < b.length; k++) {
+        b.members[k * POOL_LANES + lane] = n;
+    }
+    return id;
+}
+
+node_set ColumnPool::get_set(column_id id) const
+{
+    members const m = get_members(id);
+    return {m.begin(), m.end()};
+}
+
+vector<node_set> ColumnPool::get_sets(const vector<column_id>& ids) const
+{
+    vector<node_set> sets = {};
+    for (column_id const id : ids) {
+        sets.push_back(get_set(id));
+    }
+    return sets;
+}
+
+void ColumnPool::set_graph(const Graph& g)
+{
+    active.assign(words, 0);
+    adjacency.assign((size_t)n * words, 0);
+    for_nodes(g, u) {
+        active[u / 64] |= 1ULL << (u % 64);
+        const bitset<MAX_NODES>& adj = g.get_adj_bool(u);
+        for_nodes(g, v) {
+            if (adj[v]) {
+                adjacency[(size_t)u * words + v / 64] |= 1ULL << (v % 64);
+            }
+        }
+    }
+}
+
+bool ColumnPool::is_valid(size_t id) const
+{
+    const uint64_t* w = get_bits(id);
+    for (size_t i = 0; i < words; i++) {
+        if ((w[i] & ~active[i]) != 0) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < words; i++) {
+        for (uint64_t word = w[i]; word != 0; word &= word - 1) {
+            size_t const u = i * 64 + __builtin_ctzll(word);
+            const uint64_t* adj = &adjacency[u * words];
+            for (size_t k = 0; k < words; k++) {
+                if ((adj[k] & w[k]) != 0) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+vector<column_id> ColumnPool::violated(const vector<cost>& weight,
+                                      size_t max_sets) const
+{
+    // inactive nodes and the padding weigh 0
+    vector<double> w(n + 1, 0.0);
+    for (node u = 0; u < n; u++) {
+        if ((active[u / 64] >> (u % 64)) & 1) {
+            w[u] = weight[u];
+        }
+    }
+
+    vector<pair<double, size_t>> candidates = {};
+    for (size_t b = 0; b < blocks.size(); b++) {
+        double sum[POOL_LANES];
+        block_sums(w.data(), blocks[b].members.data(), blocks[b].length, sum);
+        for (size_t j = 0; j < POOL_LANES; j++) {
+            size_t const id = b * POOL_LANES + j;
+            if (id < size() and sum[j] > 1 + EPS) {
+                candidates.push_back({sum[j], id});
+            }
+        }
+    }
+
+    // the most violated first, and the oldest between equals
+    sort(candidates.begin(),
+         candidates.end(),
+         [](auto const& a, auto const& b) {
+             return a.first > b.first or
+                 (a.first == b.first and a.second < b.second);
+         });
+    vector<column_id> ids = {};
+    for (auto const& [value, id] : candidates) {
+        if (ids.size() >= max_sets) {
+            break;
+        }
+        if (is_valid(id)) {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
@@ -1,8 +1,17 @@
 #include <algorithm>
-#include <stack>
+#include <array>
+#include <cstdint>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "pricing.hpp"
 
+#include "../incl/parallel.hpp"
 #include "../incl/utils.hpp"
 
 struct mwis_sol
@@ -11,10 +20,83 @@ struct mwis_sol
     node_set nodes;
 };
 
+/*
+** Weighted clique cover of the graph of a branch-and-bound node.
+** Each clique keeps its members sorted in descending order of weight, so the
+** weight of a clique is the weight of its first member that is still active.
+*/
+struct clique_cover
+{
+    vector<vector<node>> cliques;
+    node built_n;  // number of active nodes when the cover was built
+};
+
+/*
+** The cover is shared by every node of a subtree: deactivating vertices keeps
+** each clique a clique, so a node only has to advance the heads of the
+** cliques that lost their heaviest member.
+*/
+struct wcc_state
+{
+    shared_ptr<const clique_cover> cover;
+    vector<unsigned int> head;
+    cost value;
+};
+
 struct branch_node
 {
     Graph g;
     mwis_sol sol;
+    wcc_state wcc;
+};
+
+using candidate_pool = unordered_map<node_set, cost, node_set_hash>;
+using column_sink = Sink<mwis_sol>;
+
+/*
+** Best solution of a search, shared by all its workers. Workers prune
+** against value(), a lock-free copy rounded down so it never prunes more
+** than the exact value would.
+*/
+class incumbent
+{
+  public:
+    explicit incumbent(cost lower)
+        : sol {lower, {}}
+        , bound(round_down(lower))
+    {
+    }
+
+    cost value() const { return bound.load(memory_order_relaxed); }
+
+    void offer(const mwis_sol& s)
+    {
+        if (s.value <= value()) {
+            return;
+        }
+        lock_guard<mutex> const lock(m);
+        if (s.value > sol.value) {
+            sol = s;
+            bound.store(round_down(s.value), memory_order_relaxed);
+        }
+    }
+
+    mwis_sol get()
+    {
+        lock_guard<mutex> const lock(m);
+        return sol;
+    }
+
+  private:
+    mutex m;
+    mwis_sol sol;
+    atomic<double> bound;
+
+    static double round_down(cost v)
+    {
+        auto d = static_cast<double>(v);
+        return d > v ? nextafter(d, -INFINITY) : d;
+    }
 };
 
 /*
@@ -134,8 +216,12 @@ node_set confine(const Graph& g, Graph::node v, const vector<cost>& weight)
 ** single vertex clique to C and assign it the weight of the vertex.
 ** Afterwards the vertex is marked as processed and we continue with the
 ** next one." -- Lamm2018, page6
+**
+** Since the vertices are visited in descending order of weight, cliques are
+** created in descending order of weight too, so the first clique in which u
+** fits is the one with maximum weight.
 */
-cost mwis_ub(const branch_node n, const vector<cost>& weight)
+void wcc_build(branch_node& n, const vector<cost>& weight)
 {
     // sort the vertices in descending order of their weight
     vector<Graph::node> sorted_nodes = {};
@@ -152,30 +238,232 @@ cost mwis_ub(const branch_node n, const vector<cost>& weight)
                   return weight[a] > weight[b];
               });
 
-    // iterate over the sorted vertices and search for the clique with
-    // maximum weight which it can be added to.
-    vector<pair<node_set, cost>> cliques = {};
-    cost wcc = 0;
+    auto cover = make_shared<clique_cover>();
+    cover->built_n = sorted_nodes.size();
+    vector<bitset<MAX_NODES>> members = {};
     for (Graph::node const u : sorted_nodes) {
-        pair<node_set, cost>* max_clique = nullptr;
-        node_set const onu = n.g.get_open_neighborhood(u);
-        for (pair<node_set, cost>& clique : cliques) {
-            if (clique.first == onu
-                and (max_clique == nullptr
-                     or clique.second > max_clique->second))
-            {
-                max_clique = &clique;
+        const bitset<MAX_NODES>& adj_u = n.g.get_adj_bool(u);
+        size_t c = 0;
+        // all members of the clique must be adjacent to u
+        while (c < members.size() and (members[c] & adj_u) != members[c]) {
+            c++;
+        }
+        if (c == members.size()) {
+            members.emplace_back();
+            cover->cliques.emplace_back();
+        }
+        members[c][u] = true;
+        cover->cliques[c].push_back(u);
+    }
+
+    n.wcc.value = 0;
+    n.wcc.head.assign(cover->cliques.size(), 0);
+    for (const vector<node>& clique : cover->cliques) {
+        n.wcc.value += weight[clique.front()];
+    }
+    n.wcc.cover = std::move(cover);
+}
+
+/*
+** Update the weighted clique cover inherited from the parent node: vertices
+** removed since then leave their cliques, and a clique whose heaviest member
+** left now weights as its next active member.
+*/
+void wcc_update(branch_node& n, const vector<cost>& weight)
+{
+    const vector<vector<node>>& cliques = n.wcc.cover->cliques;
+    for (size_t c = 0; c < cliques.size(); c++) {
+        unsigned int& h = n.wcc.head[c];
+        if (h == cliques[c].size() or n.g.is_active(cliques[c][h])) {
+            continue;
+        }
+        n.wcc.value -= weight[cliques[c][h]];
+        while (h < cliques[c].size() and not n.g.is_active(cliques[c][h])) {
+            h++;
+        }
+        if (h < cliques[c].size()) {
+            n.wcc.value += weight[cliques[c][h]];
+        }
+    }
+}
+
+/*
+** Upper bound for the MWIS of the node given by its weighted clique cover.
+** The inherited cover gets looser as the graph shrinks, so if it does not
+** prune the node and the graph has halved since it was built, we build a
+** new one for this subtree.
+*/
+cost mwis_ub(branch_node& n, const vector<cost>& weight, const cost& best)
+{
+    if (n.wcc.cover == nullptr) {
+        wcc_build(n, weight);
+    } else {
+        wcc_update(n, weight);
+    }
+
+    cost const ub = n.sol.value + n.wcc.value;
+    if (ub <= best or 2 * n.g.get_active_n() > n.wcc.cover->built_n) {
+        return ub;
+    }
+
+    wcc_build(n, weight);
+    return n.sol.value + n.wcc.value;
+}
+
+/*
+** Xiao2023 suggests using a faster exact method once the graph is small.
+** The (at most 64) active nodes are relabeled 0..k-1 in descending order of
+** weight and every set of nodes is a single uint64_t mask, so the search is a
+** plain recursion over masks that never touches the heap.
+*/
+static_assert(PRICING_SMALL_GRAPH <= 64, "Small graphs must fit in 64 bits.");
+
+struct small_graph
+{
+    int k;
+    array<Graph::node, 64> label;
+    array<uint64_t, 64> adj;
+    array<cost, 64> weight;
+
+    cost base;  // weight of the solution of the branch-and-bound node
+    cost best;
+    uint64_t best_mask;
+    // last improving solutions found along the search
+    array<uint64_t, PRICING_MAX_COLUMNS> found;
+    int n_found;
+};
+
+inline uint64_t bit(int u)
+{
+    return uint64_t(1) << u;
+}
+
+inline int lowest(uint64_t mask)
+{
+    return __builtin_ctzll(mask);
+}
+
+/*
+** Weighted clique cover of the nodes in mask. As in wcc_build, the first
+** clique in which a node fits is the heaviest one, since labels follow the
+** descending order of weight.
+*/
+cost small_ub(const small_graph& s, uint64_t mask)
+{
+    array<uint64_t, 64> cliques;
+    int n_cliques = 0;
+    cost ub = 0;
+    for (; mask != 0; mask &= mask - 1) {
+        int const u = lowest(mask);
+        int c = 0;
+        while (c < n_cliques and (cliques[c] & s.adj[u]) != cliques[c]) {
+            c++;
+        }
+        if (c == n_cliques) {
+            cliques[n_cliques++] = 0;
+            ub += s.weight[u];
+        }
+        cliques[c] |= bit(u);
+    }
+    return ub;
+}
+
+void small_search(small_graph& s, uint64_t mask, uint64_t taken, cost value)
+{
+    // nodes without neighbours in mask are always in the solution
+    for (uint64_t m = mask; m != 0; m &= m - 1) {
+        int const u = lowest(m);
+        if ((s.adj[u] & mask) == 0) {
+            mask &= ~bit(u);
+            taken |= bit(u);
+            value += s.weight[u];
+        }
+    }
+
+    if (value > s.best) {
+        s.best = value;
+        s.best_mask = taken;
+        if (s.base + value > 1 + EPS) {
+            s.found[s.n_found++ % PRICING_MAX_COLUMNS] = taken;
+        }
+    }
+    if (mask == 0 or value + small_ub(s, mask) <= s.best) {
+        return;
+    }
+
+    // branch on the node with the most neighbours in mask
+    int v = lowest(mask);
+    for (uint64_t m = mask; m != 0; m &= m - 1) {
+        int const u = lowest(m);
+        if (__builtin_popcountll(s.adj[u] & mask)
+            > __builtin_popcountll(s.adj[v] & mask))
+        {
+            v = u;
+        }
+    }
+
+    small_search(
+        s, mask & ~s.adj[v] & ~bit(v), taken | bit(v), value + s.weight[v]);
+    small_search(s, mask & ~bit(v), taken, value);
+}
+
+/*
+** Solve the MWIS of a node with at most PRICING_SMALL_GRAPH active nodes.
+** Only solutions better than best are searched for, and the violated ones
+** found along the way are pushed to the sink, if any.
+*/
+mwis_sol mwis_small(const branch_node& n,
+                    const vector<cost>& weight,
+                    const cost& best,
+                    column_sink* sink)
+{
+    small_graph s;
+    s.k = 0;
+    for_nodes(n.g, u) {
+        s.label[s.k++] = u;
+    }
+    std::sort(s.label.begin(),
+              s.label.begin() + s.k,
+              [&weight](Graph::node a, Graph::node b)
+              { return weight[a] > weight[b]; });
+
+    for (int i = 0; i < s.k; i++) {
+        s.weight[i] = weight[s.label[i]];
+        s.adj[i] = 0;
+        for (int j = 0; j < s.k; j++) {
+            if (n.g.get_adj_bool(s.label[i])[s.label[j]]) {
+                s.adj[i] |= bit(j);
             }
         }
-        if (max_clique == nullptr) {
-            cliques.push_back({{u}, weight[u]});
-            wcc += weight[u];
-        } else {
-            max_clique->first.insert(u);
+    }
+
+    s.base = n.sol.value;
+    s.best = best - n.sol.value;
+    s.best_mask = 0;
+    s.n_found = 0;
+    uint64_t const all = s.k == 64 ? ~uint64_t(0) : bit(s.k) - 1;
+    small_search(s, all, 0, 0);
+
+    auto to_sol = [&s, &n](uint64_t mask)
+    {
+        mwis_sol sol = n.sol;
+        for (; mask != 0; mask &= mask - 1) {
+            sol.value += s.weight[lowest(mask)];
+            sol.nodes.insert(s.label[lowest(mask)]);
         }
+        return sol;
+    };
+
+    for (int i = 0; sink != nullptr and i < min(s.n_found, PRICING_MAX_COLUMNS);
+         i++)
+    {
+        sink->push(to_sol(s.found[i]));
     }
 
-    return wcc;
+    if (s.best_mask == 0) {
+        return n.sol;
+    }
+    return to_sol(s.best_mask);
 }
 
 /*
@@ -230,9 +518,10 @@ void reduce(branch_node& n, const vector<cost>& weight)
 
 /*
 ** Function that determines wheter or not to branch.
-** If so, add the branch to the "tree" (stack).
+** If so, add the branch to the children, in the order they are to be pushed
+** to the "tree".
 */
-void branch(stack<branch_node>& tree,
+void branch(vector<branch_node>& children,
             branch_node& b_node,
             const vector<cost>& weight)
 {
@@ -260,34 +549,315 @@ void branch(stack<branch_node>& tree,
         sol1.nodes.insert(u);
     }
 
-    if (not g1.is_empty()) {
-        tree.push({g1, sol1});
-    }
+    // even if g1 is empty, sol1 itself has to be evaluated
+    children.push_back({std::move(g1), sol1, b_node.wcc});
 
     // Branching 2 : delete v
     Graph g2 = Graph(b_node.g);
     g2.deactivate(v);
     if (not g2.is_empty()) {
-        tree.push({g2, b_node.sol});
+        children.push_back({std::move(g2), b_node.sol, b_node.wcc});
+    }
+}
+
+/*
+** Check if the candidate s is diverse enough from the sets already chosen,
+** according to PRICING_DIVERSITY.
+*/
+bool is_diverse(const node_set& s,
+                const vector<node_set>& chosen,
+                const vector<bool>& covered)
+{
+    if (PRICING_DIVERSITY == pricing::diversity::coverage) {
+        size_t new_nodes = 0;
+        for (node const u : s) {
+            new_nodes += covered[u] ? 0 : 1;
+        }
+        return new_nodes >= PRICING_MIN_NEW_NODES;
+    }
+
+    for (const node_set& t : chosen) {
+        size_t const common = set_intersection(s, t).size();
+        if (common > PRICING_MAX_OVERLAP * min(s.size(), t.size())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+** Choose, from the most violated to the least, up to PRICING_MAX_COLUMNS
+** diverse candidates. The most violated one is always chosen.
+*/
+vector<node_set> choose_columns(const Graph& g, const candidate_pool& pool)
+{
+    vector<pair<cost, const node_set*>> sorted = {};
+    for (const auto& [s, value] : pool) {
+        sorted.emplace_back(value, &s);
+    }
+    // break ties by the sets themselves so the choice does not depend on the
+    // order of the hash table
+    std::sort(sorted.begin(),
+              sorted.end(),
+              [](const auto& a, const auto& b)
+              {
+                  if (a.first == b.first) {
+                      return *a.second < *b.second;
+                  }
+                  return a.first > b.first;
+              });
+
+    vector<node_set> chosen = {};
+    vector<bool> covered(g.get_n(), false);
+    for (const auto& [value, s] : sorted) {
+        if (chosen.size() >= PRICING_MAX_COLUMNS) {
+            break;
+        }
+        if (not chosen.empty() and not is_diverse(*s, chosen, covered)) {
+            continue;
+        }
+        chosen.push_back(*s);
+        for (node const u : *s) {
+            covered[u] = true;
+        }
+    }
+    return chosen;
+}
+
+struct bnb_stats
+{
+    int count;
+    int pruned;
+    int small;
+    int split;
+};
+
+mwis_sol mwis_bnb(const Graph&,
+                  const vector<cost>&,
+                  const cost&,
+                  column_sink*,
+                  bnb_stats&,
+                  unsigned int);
+
+/*
+** Connected components of the graph, found by a BFS over the adjacency
+** bitsets.
+*/
+vector<bitset<MAX_NODES>> components(const Graph& g)
+{
+    vector<bitset<MAX_NODES>> comps = {};
+    bitset<MAX_NODES> left = g.get_active();
+    for_nodes(g, start) {
+        if (not left[start]) {
+            continue;
+        }
+        bitset<MAX_NODES> comp;
+        bitset<MAX_NODES> frontier;
+        frontier[start] = true;
+        while (frontier.any()) {
+            comp |= frontier;
+            bitset<MAX_NODES> next;
+            for_nodes(g, u) {
+                if (frontier[u]) {
+                    next |= g.get_adj_bool(u);
+                }
+            }
+            frontier = next & ~comp;
+        }
+        left &= ~comp;
+        comps.push_back(comp);
+    }
+    return comps;
+}
+
+/*
+** If the graph of the node is disconnected, solve each component on its own
+** and add up their solutions, from the smallest component to the largest.
+** A component only needs to beat the incumbent once the components already
+** solved and the clique cover bound of the others are counted, so the node
+** is dropped as soon as one of them cannot.
+** Returns false if the graph is connected.
+*/
+bool split(branch_node& n,
+           const vector<cost>& weight,
+           incumbent& best,
+           column_sink* sink,
+           bnb_stats& stats)
+{
+    vector<bitset<MAX_NODES>> comps = components(n.g);
+    if (comps.size() <= 1) {
+        return false;
+    }
+    stats.split++;
+
+    std::sort(comps.begin(),
+              comps.end(),
+              [](const auto& a, const auto& b) { return a.count() < b.count(); });
+
+    // upper bound of each component from the cover, which is up to date
+    // since mwis_ub was called on this node
+    vector<cost> ub(comps.size(), 0);
+    const vector<vector<node>>& cliques = n.wcc.cover->cliques;
+    for (size_t c = 0; c < cliques.size(); c++) {
+        if (n.wcc.head[c] == cliques[c].size()) {
+            continue;
+        }
+        node const head = cliques[c][n.wcc.head[c]];
+        for (size_t i = 0; i < comps.size(); i++) {
+            if (comps[i][head]) {
+                ub[i] += weight[head];
+                break;
+            }
+        }
+    }
+
+    mwis_sol sol = n.sol;
+    cost rest_ub = 0;
+    for (const cost& u : ub) {
+        rest_ub += u;
     }
+    for (size_t i = 0; i < comps.size(); i++) {
+        rest_ub -= ub[i];
+        Graph comp_g = Graph(n.g);
+        for_nodes(comp_g, u) {
+            if (not comps[i][u]) {
+                comp_g.deactivate(u);
+            }
+        }
+
+        // components are solved sequentially by the worker of this node
+        cost const target = best.value() - sol.value - rest_ub;
+        mwis_sol const comp_sol =
+            mwis_bnb(comp_g, weight, max(target, (cost)0), nullptr, stats, 1);
+        if (comp_sol.nodes.empty() or comp_sol.value <= target) {
+            stats.pruned++;
+            return true;
+        }
+        sol.value += comp_sol.value;
+        sol.nodes.insert(comp_sol.nodes.begin(), comp_sol.nodes.end());
+    }
+
+    if (sink != nullptr and sol.value > 1 + EPS) {
+        sink->push(sol);
+    }
+    best.offer(sol);
+    return true;
 }
 
 /*
-** while there is a branch-and-bound node to be searched
-** get the next one
+** Process one node of the branch-and-bound:
 ** G, sol <- reduce(G, w)
+** if G is small, solve it exactly and return
 ** actual = sol + greedy(G, w)
 ** best <- max{best, actual}
-** if actual <= best, then continue
+** if ub(G) <= best, then return
+** if G is disconnected, solve each component and return
 ** v <- the vertex with max degree in G
-** add node (G - N[Sv], sol + v) to the branch-and-bound tree
-** add node (G - v, sol) to the branch-and-bound tree
+** add node (G - N[Sv], sol + v) to the children
+** add node (G - v, sol) to the children
+*/
+void process(branch_node& b_node,
+             const vector<cost>& weight,
+             incumbent& best,
+             column_sink* sink,
+             bnb_stats& stats,
+             vector<branch_node>& children)
+{
+    // out of time, the node is dropped and the search ends without proving
+    // its MWIS, which the solver knows from time_out()
+    if (time_out()) {
+        return;
+    }
+    stats.count++;
+
+    // reduce b_node.g and may populate solution b_node.sol
+    reduce(b_node, weight);
+
+    if (b_node.g.get_active_n() <= PRICING_SMALL_GRAPH) {
+        best.offer(mwis_small(b_node, weight, best.value(), sink));
+        stats.small++;
+        return;
+    }
+
+    mwis_sol const heu_sol = mwis_heu(b_node, weight);
+
+    // BUG Caso infinito, conferir se EPS é maior que o EPS dado ao Gurobi.
+    if (sink != nullptr and heu_sol.value > 1 + EPS) {
+        sink->push(heu_sol);
+    }
+    best.offer(heu_sol);
+
+    if (b_node.g.is_empty()) {
+        return;
+    }
+    if (mwis_ub(b_node, weight, best.value()) <= best.value()) {
+        stats.pruned++;
+        return;
+    }
+    if (split(b_node, weight, best, sink, stats)) {
+        return;
+    }
+
+    branch(children, b_node, weight);
+}
+
+/*
+** Search the MWIS of g with n_workers threads (the calling one included)
+** sharing a work-stealing pool of branch-and-bound nodes.
+**
+** Only solutions with value greater than lower are searched for; if there is
+** none, the returned solution is empty. Violated solutions found along the
+** way are pushed to the sink, if any.
 */
-vector<node_set> pricing::solve(const Graph& orig, const vector<cost>& weight)
+mwis_sol mwis_bnb(const Graph& g,
+                  const vector<cost>& weight,
+                  const cost& lower,
+                  column_sink* sink,
+                  bnb_stats& stats,
+                  unsigned int n_workers)
+{
+    incumbent best(lower);
+    WorkPool<branch_node> tree(n_workers);
+    tree.push(0, {g, {0, {}}, {nullptr, {}, 0}});
+
+    vector<bnb_stats> worker_stats(n_workers, {0, 0, 0, 0});
+    auto work = [&](unsigned int id)
+    {
+        vector<branch_node> children = {};
+        while (optional<branch_node> b_node = tree.pop(id)) {
+            process(*b_node, weight, best, sink, worker_stats[id], children);
+            for (branch_node& child : children) {
+                tree.push(id, std::move(child));
+            }
+            children.clear();
+            tree.done();
+        }
+    };
+
+    vector<thread> workers = {};
+    for (unsigned int id = 1; id < n_workers; id++) {
+        workers.emplace_back(work, id);
+    }
+    work(0);
+    for (thread& t : workers) {
+        t.join();
+    }
+
+    for (const bnb_stats& s : worker_stats) {
+        stats.count += s.count;
+        stats.pruned += s.pruned;
+        stats.small += s.small;
+        stats.split += s.split;
+    }
+    return best.get();
+}
+
+vector<node_set> pricing::solve(const Graph& orig,
+                                const vector<cost>& weight,
+                                cost& mwis)
 {
     LOG_SCOPE_F(INFO, "Pricing.");
     Graph g = Graph(orig);
-    vector<node_set> new_indep_sets = {};
 
     // Remove all nodes with weight 0
     for_nodes(g, n) {
@@ -299,56 +869,43 @@ vector<node_set> pricing::solve(const Graph& orig, const vector<cost>& weight)
     log_graph_stats(g, "Original");
     log_graph_stats(g, "Reduced");
 
-    stack<branch_node> tree;
-    tree.push({g, {0, {}}});
-    mwis_sol best = {0, {}};
-
-    int count = 0;
-    while (!tree.empty()) {
-        count++;
-        branch_node b_node = tree.top();
-        tree.pop();
-
-        // reduce b_node.g and may populate solution b_node.sol
-        reduce(b_node, weight);
-
-        // TODO Xiao2023 says we can use some algorithm when the graph is small
-        // to quickly find the MWIS.
+    // in reproducible mode the search is sequential, so the same nodes are
+    // visited in the same order and the same candidates are found
+    unsigned int const n_workers = config.reproducible ? 1 : config.threads;
 
-        mwis_sol const heu_sol = mwis_heu(b_node, weight);
+    bnb_stats stats = {0, 0, 0, 0};
+    column_sink sink;
+    mwis_sol const best = mwis_bnb(g, weight, 0, &sink, stats, n_workers);
+    mwis = best.value;
 
-        // BUG Caso infinito, conferir se EPS é maior que o EPS dado ao Gurobi.
-        if (heu_sol.value > 1 + EPS) {
-            // check if is not aldready in new_indep_set
-            if (find(
-                    new_indep_sets.begin(), new_indep_sets.end(), heu_sol.nodes)
-                != new_indep_sets.end())
-            {
-                continue;
-            }
-            new_indep_sets.push_back(heu_sol.nodes);
-        }
-
-        if (heu_sol.value > best.value) {
-            best = heu_sol;
-        }
-        if (b_node.g.is_empty()) {
-            continue;
-        }
-        if (mwis_ub(b_node, weight) <= best.value) {
-            continue;
-        }
-
-        branch(tree, b_node, weight);
+    candidate_pool pool;
+    for (mwis_sol& sol : sink.drain()) {
+        pool.emplace(std::move(sol.nodes), sol.value);
     }
-    LOG_F(INFO, "MWIS solved with value %Lf | %d branchs.", best.value, count);
+    LOG_F(INFO,
+          "MWIS solved with value %Lf | %d branchs | %d pruned | %d small | %d "
+          "split.",
+          best.value,
+          stats.count,
+          stats.pruned,
+          stats.small,
+          stats.split);
 
     LOG_SCOPE_F(INFO, "Maximal set.");
-    for (node_set& s : new_indep_sets) {
+    vector<node_set> new_indep_sets = {};
+    unordered_set<node_set, node_set_hash> maximal = {};
+    for (node_set s : choose_columns(g, pool)) {
         maximal_set(g, s);
+        // two candidates may be extended to the same maximal set
+        if (maximal.insert(s).second) {
+            new_indep_sets.push_back(s);
+        }
     }
 
-    LOG_F(INFO, "Found %lu independent sets violated.", new_indep_sets.size());
+    LOG_F(INFO,
+          "Found %lu independent sets violated, returning %lu.",
+          pool.size(),
+          new_indep_sets.size());
 
     return new_indep_sets;
 }
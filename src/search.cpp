@@ -0,0 +1,202 @@
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <thread>
+
+#include "../incl/search.hpp"
+
+#include "../incl/branch.hpp"
+#include "../incl/parallel.hpp"
+
+TreeWorker::TreeWorker(const Graph& g)
+    : _g(g)
+    , _pool(g.get_n())
+    , _solver(_pool)
+{
+}
+
+cost TreeWorker::process(const open_node& n,
+                         const cost& upper_bound,
+                         vector<node_set>& coloring,
+                         vector<open_node>& children)
+{
+    if (ceil(n.obj_val) >= upper_bound) {
+        return 0;
+    }
+    if (time_out()) {
+        children.push_back(n);
+        return 0;
+    }
+    replay(_g, _path, n.path);
+
+    vector<column_id> indep_sets;
+    for (const node_set& set : *n.indep_sets) {
+        indep_sets.push_back(_pool.insert(set));
+    }
+    if (_path.empty()) {
+        // enrich may extend two sets to the same one
+        sort(indep_sets.begin(), indep_sets.end());
+        indep_sets.erase(unique(indep_sets.begin(), indep_sets.end()),
+                         indep_sets.end());
+    } else {
+        auto const [t, u, v] = _path.back();
+        indep_sets = clean_sets(_g, _pool, t, indep_sets, u, v);
+    }
+
+    vector<cost> x_s;
+    // a column generation stopped early may not reach the bound the parent
+    // already proved
+    cost const sol = max(n.obj_val,
+                         _solver.solve(_g,
+                                       indep_sets,
+                                       x_s,
+                                       upper_bound,
+                                       0,
+                                       nullptr,
+                                       _path.empty() ? solve_type::root
+                                                     : solve_type::node));
+    LOG_F(INFO, "Solved with value %Lf", sol);
+
+    // a node cut by the time limit stays open, with the bound it reached
+    if (time_out()) {
+        children.push_back(n);
+        children.back().obj_val = sol;
+        return 0;
+    }
+
+    cost value = 0;
+    if (integral(x_s)) {
+        coloring.clear();
+        for (size_t i = 0; i < indep_sets.size(); i++) {
+            value += round(x_s[i]);
+            if (x_s[i] >= 1 - EPS) {
+                coloring.push_back(_pool.get_set(indep_sets[i]));
+            }
+        }
+        _g.apply_changes_to_sol(coloring);
+    }
+
+    if (ceil(sol) < min(upper_bound, value > 0 ? value : upper_bound)) {
+        auto [u, v] = find_vertexes(_g, _pool, indep_sets, x_s);
+        if (u < _g.get_n() and v < _g.get_n()) {
+            auto const sets = make_shared<const vector<node_set>>(
+                _pool.get_sets(indep_sets));
+            for (mod_type const t : {mod_type::contract, mod_type::conflict}) {
+                children.push_back({sol, _path, sets});
+                children.back().path.push_back(Graph::mod {t, u, v});
+            }
+        }
+    }
+    return value;
+}
+
+void TreeWorker::add_columns(const vector<node_set>& sets)
+{
+    for (const node_set& set : sets) {
+        _pool.insert(set);
+    }
+    _reported = _pool.size();
+}
+
+vector<node_set> TreeWorker::new_columns()
+{
+    vector<node_set> sets = {};
+    for (; _reported < _pool.size(); _reported++) {
+        sets.push_back(_pool.get_set(_reported));
+    }
+    return sets;
+}
+
+namespace
+{
+/*
+** Best coloring found by any worker. Its number of colors is read without a
+** lock for the pruning; a better one is only logged under the lock.
+*/
+class incumbent
+{
+  public:
+    incumbent(const Graph& g, cost upper_bound)
+        : g(g)
+        , colors(static_cast<color>(upper_bound))
+    {
+    }
+
+    cost value() const { return colors.load(memory_order_relaxed); }
+
+    void offer(const vector<node_set>& coloring, color value)
+    {
+        if (value >= colors.load(memory_order_relaxed)) {
+            return;
+        }
+        lock_guard<mutex> const lock(m);
+        if (value < colors.load(memory_order_relaxed)) {
+            colors.store(value, memory_order_relaxed);
+            log_bound("UB", value);
+            log_solution(g, coloring, vector<cost>(coloring.size(), 1), value);
+        }
+    }
+
+  private:
+    const Graph& g;
+    atomic<color> colors;
+    mutex m;
+};
+}  // namespace
+
+cost parallel_search(const Graph& orig,
+                     const vector<node_set>& initial_sets,
+                     cost upper_bound,
+                     cost& lower_bound)
+{
+    LOG_SCOPE_F(INFO, "Parallel search.");
+    unsigned int const n_workers = config.tree_threads;
+    incumbent best(orig, upper_bound);
+    WorkPool<open_node> tree(n_workers);
+    // once out of time, the open nodes are only drained for their bounds
+    mutex open_m;
+    cost open_bound = upper_bound;
+    tree.push(
+        0, {0, {}, make_shared<const vector<node_set>>(initial_sets)});
+
+    auto work = [&](unsigned int id)
+    {
+        loguru::set_thread_name(("tree " + to_string(id)).c_str());
+        TreeWorker worker(orig);
+        vector<node_set> coloring;
+        vector<open_node> children;
+
+        while (optional<open_node> n = tree.pop(id)) {
+            if (time_out()) {
+                lock_guard<mutex> const lock(open_m);
+                open_bound = min(open_bound, n->obj_val);
+                tree.done();
+                continue;
+            }
+            cost const value =
+                worker.process(*n, best.value(), coloring, children);
+            if (value > 0) {
+                best.offer(coloring, (color)value);
+            }
+            // the last one pushed is taken first: conflict
+            for (open_node& child : children) {
+                tree.push(id, std::move(child));
+            }
+            children.clear();
+            tree.done();
+        }
+        worker.log_stats();
+    };
+
+    vector<thread> workers = {};
+    for (unsigned int id = 1; id < n_workers; id++) {
+        workers.emplace_back(work, id);
+    }
+    work(0);
+    for (thread& t : workers) {
+        t.join();
+    }
+
+    lower_bound = min(open_bound, best.value());
+    return best.value();
+}
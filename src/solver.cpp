@@ -0,0 +1,394 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "../incl/solver.hpp"
+
+#include "../incl/pricing.hpp"
+#include "../incl/utils.hpp"
+
+// works both for a node_set and the members of a set in the pool
+template<typename T>
+static cost set_weight(const T& set, const vector<cost>& weight)
+{
+    cost sum = 0;
+    for (node const v : set) {
+        sum += weight[v];
+    }
+    return sum;
+}
+
+Solver::Solver(ColumnPool& pool)
+    : _pool(pool)
+    , _master(pool)
+{
+}
+
+/*
+** Take out of the node the columns that are nonbasic with a large reduced
+** cost for PURGE_AGE rounds in a row. They are still in the pool.
+*/
+void Solver::age_columns(vector<column_id>& indep_sets,
+                         const vector<cost>& duals)
+{
+    if (PURGE_AGE == 0) {
+        return;
+    }
+
+    _age.resize(_pool.size(), 0);
+    vector<column_id> purged = {};
+    auto last = remove_if(
+        indep_sets.begin(), indep_sets.end(), [&](column_id const id) {
+            if (_master.get_value(id) > EPS or
+                1 - set_weight(_pool.get_members(id), duals) <=
+                    PURGE_REDUCED_COST) {
+                _age[id] = 0;
+                return false;
+            }
+            if (++_age[id] < PURGE_AGE) {
+                return false;
+            }
+            _age[id] = 0;
+            purged.push_back(id);
+            return true;
+        });
+    indep_sets.erase(last, indep_sets.end());
+    if (purged.empty()) {
+        return;
+    }
+
+    _master.remove_columns(purged);
+    _purged += purged.size();
+    LOG_F(INFO, "Purged %lu sets.", purged.size());
+}
+
+/*
+** Reduced-cost fixing: with duals that are dual feasible, of objective bound,
+** any coloring that uses a set has at least bound plus its reduced cost
+** colors. The sets out of the solution that cannot be in a coloring better
+** than the upper bound leave the node, with their values.
+*/
+void Solver::fix_columns(vector<column_id>& indep_sets,
+                         vector<cost>& x_s,
+                         const vector<cost>& duals,
+                         const cost& bound,
+                         const cost& upper_bound,
+                         vector<column_id>& fixed)
+{
+    size_t kept = 0;
+    size_t const before = fixed.size();
+    for (size_t i = 0; i < indep_sets.size(); i++) {
+        column_id const id = indep_sets[i];
+        cost const reduced = 1 - set_weight(_pool.get_members(id), duals);
+        if (x_s[i] <= EPS and ceil(bound + reduced - EPS) >= upper_bound) {
+            fixed.push_back(id);
+            continue;
+        }
+        indep_sets[kept] = id;
+        x_s[kept] = x_s[i];
+        kept++;
+    }
+    indep_sets.resize(kept);
+    x_s.resize(kept);
+    if (fixed.size() == before) {
+        return;
+    }
+
+    // a set fixed before may come back from the pricing
+    sort(fixed.begin(), fixed.end());
+    fixed.erase(unique(fixed.begin(), fixed.end()), fixed.end());
+    _fixed += fixed.size() - before;
+    LOG_F(INFO,
+          "Fixed %lu sets by their reduced cost (bound %Lf, UB %Lf).",
+          fixed.size() - before,
+          bound,
+          upper_bound);
+}
+
+/*
+** Whether the branching can split the LP solution: some set with two nodes
+** or more has a fractional value.
+*/
+bool Solver::is_fractional(const vector<column_id>& indep_sets) const
+{
+    for (column_id const id : indep_sets) {
+        cost const x = _master.get_value(id);
+        if (EPS < x and x < 1 - EPS and _pool.get_members(id).size() > 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+** Solve the LP of the node by column generation. With smoothing, the pricing
+** runs on a point between the duals of the LP and the stability center, and
+** only the sets violated by the duals themselves are added. When none is
+** (a mispricing), the point is moved towards the duals until it reaches
+** them, so the node still ends with an exact pricing on the true duals.
+**
+** Every round also gives a Farley bound, so the column generation stops as
+** soon as the LP cannot improve its rounded value, or the node is pruned by
+** the upper bound. The best of these bounds is returned, not the objective
+** of the last LP, which may not be optimal. It also stops when the LP tails
+** off, except at the root, if there is a fractional solution to branch on.
+**
+** Once the time limit is spent it stops with the best bound found so far.
+**
+** The scaled weights of the best Farley bound are dual feasible, so they fix
+** the sets of the node by their reduced cost at its end. The sets fixed in
+** an ancestor are not taken from the pool, and are only added from the
+** pricing when it finds no other set, so the bound stays exact.
+*/
+cost Solver::solve(const Graph& g,
+                   vector<column_id>& indep_sets,
+                   vector<cost>& x_s,
+                   const cost& upper_bound,
+                   int max_rounds,
+                   vector<column_id>* fixed,
+                   solve_type type)
+{
+    LOG_SCOPE_F(INFO, "Solver.");
+    DCHECK_F(g.get_n() > 0, "Graph is empty.");
+    DCHECK_F(check_indep_sets(g, _pool.get_sets(indep_sets)),
+             "Invalid independent sets.");
+
+    // === Update the model to this node ===
+    _master.sync(g, indep_sets);
+    _pool.set_graph(g);
+
+    LOG_F(INFO, "Node model with %d sets.", (int)indep_sets.size());
+    bool const root = type == solve_type::root;
+    if (type != solve_type::probe) {
+        _nodes++;
+    }
+
+    // === Solve the model ===
+    vector<cost> duals(g.get_n());
+    vector<cost> weight(g.get_n());
+    vector<cost> center = {};
+    cost best_bound = 0;
+    // dual feasible point of the best Farley bound of the pricing
+    vector<cost> feasible = {};
+    cost feasible_bound = 0;
+    vector<cost> objs = {};  // objective of each LP solved in the node
+    while (true) {
+        auto const start = chrono::steady_clock::now();
+        cost obj = _master.optimize();
+        if (isinf(obj)) {
+            // the singletons cover every node, so the LP is feasible with them
+            LOG_F(WARNING, "Master LP infeasible, adding the singletons.");
+            vector<column_id> singletons = {};
+            for_nodes(g, v) {
+                column_id const id = _pool.insert(node_set {v});
+                if (find(indep_sets.begin(), indep_sets.end(), id) ==
+                    indep_sets.end()) {
+                    singletons.push_back(id);
+                }
+            }
+            _master.add_columns(singletons);
+            indep_sets.insert(
+                indep_sets.end(), singletons.begin(), singletons.end());
+            obj = _master.optimize();
+            CHECK_F(not isinf(obj), "Master LP is infeasible.");
+        }
+        objs.push_back(obj);
+        _objective = obj;
+
+        // get the weights of the nodes from the dual variables
+        _master.get_duals(g, duals);
+        auto const solved = chrono::steady_clock::now();
+        _lp_time += chrono::duration<double>(solved - start).count();
+
+        age_columns(indep_sets, duals);
+
+        // sets generated in any node before are much cheaper than a pricing
+        // round, as long as they are independent in this one
+        vector<column_id> added = _pool.violated(duals, PRICING_MAX_COLUMNS);
+        auto const is_fixed = [fixed](column_id const id) {
+            return fixed != nullptr and
+                binary_search(fixed->begin(), fixed->end(), id);
+        };
+        // an LP solved within a tolerance, or cut by the time limit, may leave
+        // a set of the node violated
+        vector<bool> in_node(_pool.size(), false);
+        for (column_id const id : indep_sets) {
+            in_node[id] = true;
+        }
+        auto const is_in_node = [&in_node](column_id const id) {
+            return id < in_node.size() and in_node[id];
+        };
+        added.erase(remove_if(added.begin(), added.end(), is_in_node),
+                    added.end());
+        added.erase(remove_if(added.begin(), added.end(), is_fixed),
+                    added.end());
+        _restored += added.size();
+        for (int k = 1; added.empty(); k++) {
+            // the first round of the node has no center yet
+            cost const alpha =
+                center.empty() ? 0 : max((cost)0, 1 - k * (1 - _alpha));
+            weight = duals;
+            if (alpha > 0) {
+                for_nodes(g, v) {
+                    weight[v] = alpha * center[v] + (1 - alpha) * duals[v];
+                }
+            }
+
+            cost mwis = 0;
+            vector<node_set> sets = pricing::solve(g, weight, mwis);
+            _rounds++;
+            // the MWIS of a pricing cut by the time limit is no bound
+            if (time_out()) {
+                break;
+            }
+
+            // the weights scaled down by the MWIS are dual feasible
+            cost sum = 0;
+            for_nodes(g, v) {
+                sum += EPS * floor(weight[v] / EPS);
+            }
+            if (sum / max((cost)1, mwis) > best_bound) {
+                best_bound = sum / max((cost)1, mwis);
+                center = weight;
+                feasible_bound = best_bound;
+                feasible.resize(g.get_n());
+                for_nodes(g, v) {
+                    feasible[v] =
+                        EPS * floor(weight[v] / EPS) / max((cost)1, mwis);
+                }
+            }
+
+            // only the sets violated by the duals are of any use
+            if (alpha > 0) {
+                node_set const* best = nullptr;
+                for (const node_set& set : sets) {
+                    if (best == nullptr or
+                        set_weight(set, weight) > set_weight(*best, weight)) {
+                        best = &set;
+                    }
+                }
+                auto last = remove_if(
+                    sets.begin(), sets.end(), [&duals](const node_set& set) {
+                        return set_weight(set, duals) <= 1 + EPS;
+                    });
+                sets.erase(last, sets.end());
+                if (sets.empty()) {
+                    _mispricings++;
+                    continue;
+                }
+
+                if (SMOOTHING_AUTO) {
+                    // Subgradient of sum(pi) + obj * (1 - MWIS(pi)) at the
+                    // smoothed point: if it points to the duals, alpha is too
+                    // large. Keeping alpha at most 0.9 bounds the mispricings.
+                    cost slope = 0;
+                    for_nodes(g, v) {
+                        slope += duals[v] - weight[v];
+                    }
+                    if (mwis > 1) {
+                        slope -= obj * (set_weight(*best, duals) -
+                                        set_weight(*best, weight));
+                    }
+                    _alpha = slope > 0
+                        ? max((cost)0, _alpha - 0.1)
+                        : min((cost)0.9, _alpha + (1 - _alpha) / 10);
+                }
+            }
+            for (const node_set& set : sets) {
+                added.push_back(_pool.insert(set));
+            }
+            added.erase(remove_if(added.begin(), added.end(), is_in_node),
+                        added.end());
+            if (not all_of(added.begin(), added.end(), is_fixed)) {
+                added.erase(remove_if(added.begin(), added.end(), is_fixed),
+                            added.end());
+            }
+            break;
+        }
+        _pricing_time += chrono::duration<double>(chrono::steady_clock::now() -
+                                                  solved)
+                             .count();
+
+        if (time_out()) {
+            LOG_F(INFO, "Out of time at %Lf (bound %Lf).", obj, best_bound);
+            break;
+        }
+        if (not added.empty() and (ceil(best_bound) >= ceil(obj - EPS) or
+                                   ceil(best_bound) >= upper_bound)) {
+            LOG_F(INFO,
+                  "Stopped by the bound %Lf (LP %Lf, UB %Lf).",
+                  best_bound,
+                  obj,
+                  upper_bound);
+            _bound_stops++;
+            break;
+        }
+        if (not added.empty() and not root and TAILING_OFF_ROUNDS > 0 and
+            objs.size() > TAILING_OFF_ROUNDS and
+            objs[objs.size() - 1 - TAILING_OFF_ROUNDS] - obj <
+                TAILING_OFF_EPS * obj and
+            is_fractional(indep_sets)) {
+            LOG_F(INFO,
+                  "Tailing off at %Lf (bound %Lf).",
+                  obj,
+                  best_bound);
+            _tailing_offs++;
+            break;
+        }
+        if (added.empty()) {
+            LOG_F(INFO, "No more sets to add.");
+            break;
+        }
+        if (max_rounds > 0 and (int)objs.size() >= max_rounds) {
+            LOG_F(INFO, "Stopped after %d rounds at %Lf.", max_rounds, obj);
+            break;
+        }
+
+        DCHECK_F(check_indep_sets(g, _pool.get_sets(added)),
+                 "Invalid new sets.");
+
+        _master.add_columns(added);
+        indep_sets.insert(indep_sets.end(), added.begin(), added.end());
+    }
+
+    LOG_F(INFO, "Final model with %d sets.", (int)indep_sets.size());
+    _master.log_stats();
+
+    x_s.resize(indep_sets.size());
+    for (size_t i = 0; i < indep_sets.size(); i++) {
+        x_s[i] = _master.get_value(indep_sets[i]);
+    }
+
+    if (REDUCED_COST_FIXING and fixed != nullptr and not feasible.empty() and
+        not time_out()) {
+        fix_columns(
+            indep_sets, x_s, feasible, feasible_bound, upper_bound, *fixed);
+    }
+
+    // Return the dual objective solution, which is the last bound when the
+    // column generation finishes
+    // TODO no caso de variáveis de corte, isso deve ser ceil
+    // conferir o paper do Lotti
+    return best_bound;
+}
+
+void Solver::log_stats() const
+{
+    LOG_F(INFO,
+          "Column generation: %d nodes, %d pricing rounds (%d mispricings, "
+          "%d stopped by the bound, %d tailing off), %d sets purged, %d taken "
+          "from the pool of %lu, %d fixed by reduced cost, %lf in the LP and "
+          "%lf pricing.",
+          _nodes,
+          _rounds,
+          _mispricings,
+          _bound_stops,
+          _tailing_offs,
+          _purged,
+          _restored,
+          _pool.size(),
+          _fixed,
+          _lp_time,
+          _pricing_time);
+}
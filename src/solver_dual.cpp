@@ -1,135 +1,215 @@
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <limits>
 #include <vector>
 
 #include "../incl/solver.hpp"
 
 #include <gurobi_c++.h>
 
-#include "../incl/pricing.hpp"
 #include "../incl/utils.hpp"
 
-Solver::Solver()
-    : _env(true)
-{
-    // disable gurobi license output
-    _env.set(GRB_DoubleParam_FeasibilityTol, EPS);
-    _env.set(GRB_DoubleParam_OptimalityTol, EPS);
-    _env.set(GRB_IntParam_LogToConsole, 0);
-    _env.set(GRB_IntParam_OutputFlag, 0);
-    _env.set(GRB_IntParam_NumericFocus, 1);
-    // make gurobi use only one thread
-    if (SINGLE_THREAD) {
-        _env.set(GRB_IntParam_Threads, 1);
-    }
-    _env.start();
-}
-
 /*
-** Add a new constrain to the model and update the list of independent sets.
-** The constrain is that the sum of the weights of the nodes in the set is <= 1.
+** Here the master is solved through its dual: the variables are the weights
+** of the nodes and each set is a constrain, so the "columns" of the covering
+** LP are rows and their values are shadow prices.
 */
-void add_constrain(GRBModel& model,
-                   const vector<GRBVar>& var,
-                   map<node_set, GRBConstr>& constrs,
-                   vector<node_set>& indep_sets,
-                   const node_set& set)
+struct Master::impl
 {
-    DCHECK_F(
-        find(indep_sets.begin(), indep_sets.end(), set) == indep_sets.end(),
-        "The set %s is already in the list.",
-        to_string(set).c_str());
-
-    GRBLinExpr c = 0;
-    for (const node& n : set) {
-        c += var[n];
+    GRBEnv env;
+    unique_ptr<GRBModel> model;
+    // one variable for each node of the original graph, fixed to 0 if the
+    // node is inactive
+    vector<GRBVar> vars;
+    vector<bool> active;
+    // constrain of each set of the pool, if in_model
+    vector<GRBConstr> constrs;
+    vector<bool> in_model;
+    size_t n_constrs = 0;
+
+    // time spent inserting constrains and updating the model
+    double insert_time = 0;
+    int n_updates = 0;
+
+    impl()
+        : env(true)
+    {
+        // disable gurobi license output
+        env.set(GRB_DoubleParam_FeasibilityTol, EPS);
+        env.set(GRB_DoubleParam_OptimalityTol, EPS);
+        env.set(GRB_IntParam_LogToConsole, 0);
+        env.set(GRB_IntParam_OutputFlag, 0);
+        env.set(GRB_IntParam_NumericFocus, 1);
+        // make gurobi use only one thread
+        if (SINGLE_THREAD) {
+            env.set(GRB_IntParam_Threads, 1);
+        }
+        env.start();
+
+        model = make_unique<GRBModel>(env);
+        model->set(GRB_IntAttr_ModelSense, GRB_MAXIMIZE);
+        // Branching fixes variables and removes rows, which keeps the last
+        // basis primal feasible, while each new set is a cut of the current
+        // solution, which keeps it dual feasible: the dual simplex fits both.
+        // TODO check if its faster
+        model->set(GRB_IntParam_Method, 1);
     }
+};
 
-    HANDLE_GRB_EXCEPTION(constrs[set] = model.addConstr(c <= 1.0));
-
-    indep_sets.push_back(set);
+Master::Master(const ColumnPool& pool)
+    : _pool(pool)
+    , _impl(make_unique<impl>())
+{
 }
 
-cost Solver::solve(const Graph& g,
-                   vector<node_set>& indep_sets,
-                   map<node_set, cost>& x_s)
-{
-    LOG_SCOPE_F(INFO, "Solver.");
-    DCHECK_F(g.get_n() > 0, "Graph is empty.");
-    DCHECK_F(check_indep_sets(g, indep_sets), "Invalid independent sets.");
-
-    // === Create the model ===
-    GRBModel model(_env);
-    model.set(GRB_IntAttr_ModelSense, GRB_MAXIMIZE);
-    // change method to dual simplex
-    // TODO check if its faster
-    model.set(GRB_IntParam_Method, 1);
-
-    // each vertex has a weight
-    vector<GRBVar> vars(g.get_n());
-    for_nodes(g, n) {
-        vars[n] = model.addVar(0.0, GRB_INFINITY, 1.0, GRB_CONTINUOUS);
-    }
+Master::~Master() = default;
 
-    model.update();
+/*
+** Add a constrain for each of the sets, all at once and with a single update
+** of the model. The constrain is that the sum of the weights of the nodes in
+** the set is <= 1.
+*/
+void Master::add_columns(const vector<column_id>& sets)
+{
+    auto const start = chrono::steady_clock::now();
 
-    // sum of weights of nodes in an independent set <= 1
-    map<node_set, GRBConstr> constrs;
-    for (const node_set& set : indep_sets) {
-        DCHECK_F(!set.empty(), "Empty set in the list.");
+    _impl->constrs.resize(_pool.size());
+    _impl->in_model.resize(_pool.size(), false);
+    vector<GRBLinExpr> exprs = {};
+    for (column_id const id : sets) {
+        DCHECK_F(_pool.get_members(id).size() > 0, "Empty set in the list.");
+        DCHECK_F(not _impl->in_model[id],
+                 "The set %s is already in the list.",
+                 to_string(_pool.get_set(id)).c_str());
 
         GRBLinExpr c = 0;
-        for (node const n : set) {
-            c += vars[n];
+        for (const node& n : _pool.get_members(id)) {
+            c += _impl->vars[n];
         }
-
-        HANDLE_GRB_EXCEPTION(constrs[set] = model.addConstr(c <= 1.0));
+        exprs.push_back(c);
     }
 
-    LOG_F(INFO, "Initial model with %d sets.", (int)indep_sets.size());
-
-    // === Solve the model ===
-    vector<cost> weight(g.get_n());
-    while (true) {
-        HANDLE_GRB_EXCEPTION(model.optimize());
+    vector<char> const sense(sets.size(), GRB_LESS_EQUAL);
+    vector<double> const rhs(sets.size(), 1.0);
+    GRBConstr* new_constrs = nullptr;
+    HANDLE_GRB_EXCEPTION(new_constrs = _impl->model->addConstrs(exprs.data(),
+                                                                sense.data(),
+                                                                rhs.data(),
+                                                                nullptr,
+                                                                (int)sets.size()));
+    for (size_t i = 0; i < sets.size(); i++) {
+        _impl->constrs[sets[i]] = new_constrs[i];
+        _impl->in_model[sets[i]] = true;
+    }
+    _impl->n_constrs += sets.size();
+    delete[] new_constrs;
 
-        LOG_F(INFO,
-              "Solved in %lf with value %lf",
-              model.get(GRB_DoubleAttr_Runtime),
-              model.get(GRB_DoubleAttr_ObjVal));
+    HANDLE_GRB_EXCEPTION(_impl->model->update());
+    _impl->n_updates++;
+    _impl->insert_time +=
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
 
-        // get the weights of the nodes
-        for_nodes(g, n) {
-            weight[n] = vars[n].get(GRB_DoubleAttr_X);
+void Master::remove_columns(const vector<column_id>& sets)
+{
+    for (column_id const id : sets) {
+        if (id < _impl->in_model.size() and _impl->in_model[id]) {
+            HANDLE_GRB_EXCEPTION(_impl->model->remove(_impl->constrs[id]));
+            _impl->in_model[id] = false;
+            _impl->n_constrs--;
         }
+    }
+}
 
-        vector<node_set> const sets = pricing::solve(g, weight);
+/*
+** The variables of inactive nodes are fixed to 0, the constrains of sets that
+** are not in the node are removed and the missing ones are added. Nothing is
+** rebuilt, so Gurobi keeps the basis of the last solve.
+*/
+void Master::sync(const Graph& g, const vector<column_id>& indep_sets)
+{
+    GRBModel& model = *_impl->model;
+    vector<GRBVar>& vars = _impl->vars;
+    vector<bool>& active = _impl->active;
+    vector<bool>& in_model = _impl->in_model;
+    if (vars.empty()) {
+        for (node v = 0; v < g.get_n(); v++) {
+            vars.push_back(model.addVar(0.0, GRB_INFINITY, 1.0, GRB_CONTINUOUS));
+        }
+        active.assign(g.get_n(), true);
+    }
 
-        if (sets.empty()) {
-            LOG_F(INFO, "No more sets to add.");
-            break;
+    for (node v = 0; v < g.get_n(); v++) {
+        if (active[v] != g.is_active(v)) {
+            active[v] = g.is_active(v);
+            HANDLE_GRB_EXCEPTION(vars[v].set(GRB_DoubleAttr_UB,
+                                             active[v] ? GRB_INFINITY : 0.0));
         }
+    }
 
-        DCHECK_F(check_indep_sets(g, sets), "Invalid new sets.");
+    in_model.resize(_pool.size(), false);
+    vector<bool> wanted(_pool.size(), false);
+    for (column_id const id : indep_sets) {
+        wanted[id] = true;
+    }
+    vector<column_id> unwanted = {};
+    for (size_t id = 0; id < in_model.size(); id++) {
+        if (in_model[id] and not wanted[id]) {
+            unwanted.push_back(id);
+        }
+    }
+    remove_columns(unwanted);
 
-        for (const node_set& set : sets) {
-            add_constrain(model, vars, constrs, indep_sets, set);
+    vector<column_id> missing = {};
+    for (column_id const id : indep_sets) {
+        if (not in_model[id]) {
+            missing.push_back(id);
         }
-        LOG_F(INFO, "Added %d sets.", (int)sets.size());
     }
 
-    LOG_F(INFO, "Final model with %d sets.", (int)indep_sets.size());
+    add_columns(missing);
+}
 
-    // for each constrain, get its shadow price and save
-    // it as the correspondent x_s
-    for (const node_set& set : indep_sets) {
-        x_s[set] = constrs[set].get(GRB_DoubleAttr_Pi);
+cost Master::optimize()
+{
+    GRBModel& model = *_impl->model;
+    HANDLE_GRB_EXCEPTION(model.optimize());
+    // an unbounded packing LP is an infeasible covering one
+    int const status = model.get(GRB_IntAttr_Status);
+    if (status == GRB_UNBOUNDED or status == GRB_INF_OR_UNBD) {
+        LOG_F(INFO, "Master LP is infeasible.");
+        return numeric_limits<cost>::infinity();
     }
 
-    // Return the dual objective solution
-    cost sum = 0;
-    for_nodes(g, u) {
-        sum += EPS * floor(weight[u] / EPS);
+    LOG_F(INFO,
+          "Solved in %lf (%.0lf iterations) with value %lf",
+          model.get(GRB_DoubleAttr_Runtime),
+          model.get(GRB_DoubleAttr_IterCount),
+          model.get(GRB_DoubleAttr_ObjVal));
+
+    return model.get(GRB_DoubleAttr_ObjVal);
+}
+
+// get the weights of the nodes
+void Master::get_duals(const Graph& g, vector<cost>& weight) const
+{
+    for_nodes(g, n) {
+        weight[n] = _impl->vars[n].get(GRB_DoubleAttr_X);
     }
-    return sum;
+}
+
+// the shadow price of the constrain of the set is its x_s
+cost Master::get_value(column_id id) const
+{
+    return _impl->constrs[id].get(GRB_DoubleAttr_Pi);
+}
+
+void Master::log_stats() const
+{
+    LOG_F(INFO,
+          "Master with %lu constrains (%d updates, %lf inserting in total).",
+          _impl->n_constrs,
+          _impl->n_updates,
+          _impl->insert_time);
 }
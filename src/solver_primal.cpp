@@ -1,136 +1,249 @@
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <limits>
 #include <vector>
 
 #include "../incl/solver.hpp"
 
 #include <gurobi_c++.h>
 
-#include "../incl/pricing.hpp"
 #include "../incl/utils.hpp"
 
-Solver::Solver()
-    : _env(true)
+struct column
 {
-    // disable gurobi license output
-    _env.set(GRB_DoubleParam_FeasibilityTol, EPS);
-    _env.set(GRB_DoubleParam_OptimalityTol, EPS);
-    _env.set(GRB_IntParam_LogToConsole, 0);
-    _env.set(GRB_IntParam_OutputFlag, 0);
-    _env.set(GRB_IntParam_NumericFocus, 1);
-    // make gurobi use only one thread
-    if (SINGLE_THREAD) {
-        _env.set(GRB_IntParam_Threads, 1);
+    GRBVar var;
+    column_id id;  // set of the pool
+    bool enabled;  // false if fixed to 0 at the current node
+};
+
+struct Master::impl
+{
+    GRBEnv env;
+    unique_ptr<GRBModel> model;
+    vector<column> vars;
+    vector<int> index;  // variable of each set of the pool, -1 if it has none
+    // one constrain for each node of the original graph, its right-hand side
+    // is 1 if the node is active and 0 otherwise
+    vector<GRBConstr> constrs;
+    vector<bool> covered;
+    // the next optimize is the first one of a node
+    bool new_node = true;
+
+    // time spent inserting columns and updating the model
+    double insert_time = 0;
+    int n_updates = 0;
+
+    impl()
+        : env(true)
+    {
+        // disable gurobi license output
+        env.set(GRB_DoubleParam_FeasibilityTol, EPS);
+        env.set(GRB_DoubleParam_OptimalityTol, EPS);
+        env.set(GRB_IntParam_LogToConsole, 0);
+        env.set(GRB_IntParam_OutputFlag, 0);
+        env.set(GRB_IntParam_NumericFocus, 1);
+        // make gurobi use only one thread
+        if (SINGLE_THREAD) {
+            env.set(GRB_IntParam_Threads, 1);
+        }
+        env.start();
+
+        model = make_unique<GRBModel>(env);
+        model->set(GRB_IntAttr_ModelSense, GRB_MINIMIZE);
+        // disable presolve
+        model->set(GRB_IntParam_Presolve, 0);
     }
-    _env.start();
+};
+
+Master::Master(const ColumnPool& pool)
+    : _pool(pool)
+    , _impl(make_unique<impl>())
+{
 }
 
+Master::~Master() = default;
+
 /*
-** Add a new variable to the model and update the list of independent sets.
-** We also need to compute in which constraints this variable will be used.
+** Add a variable for each of the sets, all at once and with a single update
+** of the model. Sets that already have a variable fixed to 0 are released.
+** We also need to compute in which constraints each variable will be used.
 */
-void add_variable(GRBModel& model,
-                  map<node_set, GRBVar>& vars,
-                  vector<GRBConstr>& constrs,
-                  vector<node_set>& indep_sets,
-                  const node_set& set)
+void Master::add_columns(const vector<column_id>& sets)
 {
-    if (vars.find(set) != vars.end()) {
-        LOG_F(ERROR, "Skipping set already exists.");
-        return;
-    }
+    auto const start = chrono::steady_clock::now();
+
+    vector<int>& index = _impl->index;
+    index.resize(_pool.size(), -1);
+    vector<GRBVar> released = {};
+    vector<column_id> added = {};
+    vector<GRBColumn> cols = {};
+    for (column_id const id : sets) {
+        if (index[id] >= 0 and _impl->vars[index[id]].enabled) {
+            LOG_F(ERROR, "Skipping set already exists.");
+            continue;
+        }
+        if (index[id] >= 0) {
+            // the set was fixed to 0 by another node
+            released.push_back(_impl->vars[index[id]].var);
+            _impl->vars[index[id]].enabled = true;
+            continue;
+        }
 
-    GRBColumn col;
-    for (const node& n : set) {
-        HANDLE_GRB_EXCEPTION(col.addTerm(1.0, constrs[n]));
+        GRBColumn col;
+        for (const node& n : _pool.get_members(id)) {
+            HANDLE_GRB_EXCEPTION(col.addTerm(1.0, _impl->constrs[n]));
+        }
+        cols.push_back(col);
+        added.push_back(id);
     }
 
-    HANDLE_GRB_EXCEPTION(
-        vars[set] = model.addVar(0.0, GRB_INFINITY, 1.0, GRB_CONTINUOUS, col));
-    model.update();
+    GRBModel& model = *_impl->model;
+    vector<double> const inf(released.size(), GRB_INFINITY);
+    HANDLE_GRB_EXCEPTION(model.set(
+        GRB_DoubleAttr_UB, released.data(), inf.data(), (int)released.size()));
+
+    vector<double> const lb(added.size(), 0.0);
+    vector<double> const ub(added.size(), GRB_INFINITY);
+    vector<double> const obj(added.size(), 1.0);
+    vector<char> const type(added.size(), GRB_CONTINUOUS);
+    GRBVar* new_vars = nullptr;
+    HANDLE_GRB_EXCEPTION(new_vars = model.addVars(lb.data(),
+                                                  ub.data(),
+                                                  obj.data(),
+                                                  type.data(),
+                                                  nullptr,
+                                                  cols.data(),
+                                                  (int)added.size()));
+    for (size_t i = 0; i < added.size(); i++) {
+        index[added[i]] = _impl->vars.size();
+        _impl->vars.push_back({new_vars[i], added[i], true});
+    }
+    delete[] new_vars;
 
-    indep_sets.push_back(set);
+    HANDLE_GRB_EXCEPTION(model.update());
+    _impl->n_updates++;
+    _impl->insert_time +=
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
 }
 
-cost Solver::solve(const Graph& g,
-                   vector<node_set>& indep_sets,
-                   map<node_set, cost>& x_s)
+/*
+** The variables leave the model, and the last ones take their places in vars.
+** The pool keeps the sets, which come back as new variables.
+*/
+void Master::remove_columns(const vector<column_id>& sets)
 {
-    LOG_SCOPE_F(INFO, "Solver.");
-    DCHECK_F(g.get_n() > 0, "Graph is empty.");
-    DCHECK_F(check_indep_sets(g, indep_sets), "Invalid independent sets.");
-
-    // === Create the model ===
-    GRBModel model(_env);
-    model.set(GRB_IntAttr_ModelSense, GRB_MINIMIZE);
-    // disable presolve
-    model.set(GRB_IntParam_Presolve, 0);
-    model.set(GRB_IntParam_Method, 0);
-
-    // Each independent set has a variable
-    map<node_set, GRBVar> vars;
-    for (const auto& set : indep_sets) {
-        vars[set] = model.addVar(0.0, GRB_INFINITY, 1.0, GRB_CONTINUOUS);
+    vector<column>& vars = _impl->vars;
+    vector<int>& index = _impl->index;
+    for (column_id const id : sets) {
+        size_t const k = index[id];
+        HANDLE_GRB_EXCEPTION(_impl->model->remove(vars[k].var));
+        index[id] = -1;
+        vars[k] = vars.back();
+        vars.pop_back();
+        if (k < vars.size()) {
+            index[vars[k].id] = k;
+        }
     }
+}
 
-    model.update();
-
-    // For each vertice, it has to covered by at least one set
-    vector<GRBConstr> constrs = vector<GRBConstr>(g.get_n());
-    for_nodes(g, v) {
-        GRBLinExpr c = 0;
-        for (const auto& set : indep_sets) {
-            if (set.count(v) > 0) {
-                c += vars[set];
-            }
+/*
+** The constrains of inactive nodes are relaxed to a right-hand side of 0 and
+** the variables of sets that are not in the node are fixed to 0. Nothing is
+** rebuilt, so Gurobi keeps the basis of the last solve.
+*/
+void Master::sync(const Graph& g, const vector<column_id>& indep_sets)
+{
+    GRBModel& model = *_impl->model;
+    vector<GRBConstr>& constrs = _impl->constrs;
+    vector<bool>& covered = _impl->covered;
+    if (constrs.empty()) {
+        for (node v = 0; v < g.get_n(); v++) {
+            HANDLE_GRB_EXCEPTION(constrs.push_back(
+                model.addConstr(GRBLinExpr(0), GRB_GREATER_EQUAL, 1.0)));
         }
-
-        HANDLE_GRB_EXCEPTION(constrs[v] = model.addConstr(c >= 1.0));
+        covered.assign(g.get_n(), true);
     }
 
-    LOG_F(INFO, "Initial model with %d sets.", (int)indep_sets.size());
-
-    // === Solve the model ===
-    vector<cost> weight(g.get_n());
-    while (true) {
-        HANDLE_GRB_EXCEPTION(model.optimize());
-
-        LOG_F(INFO,
-              "Solved in %lf with value %lf",
-              model.get(GRB_DoubleAttr_Runtime),
-              model.get(GRB_DoubleAttr_ObjVal));
-
-        // get the weights of the nodes from the dual variables
-        for_nodes(g, v) {
-            weight[v] = constrs[v].get(GRB_DoubleAttr_Pi);
+    for (node v = 0; v < g.get_n(); v++) {
+        if (covered[v] != g.is_active(v)) {
+            covered[v] = g.is_active(v);
+            HANDLE_GRB_EXCEPTION(
+                constrs[v].set(GRB_DoubleAttr_RHS, covered[v] ? 1.0 : 0.0));
         }
+    }
 
-        vector<node_set> const sets = pricing::solve(g, weight);
-
-        if (sets.empty()) {
-            LOG_F(INFO, "No more sets to add.");
-            break;
+    vector<int>& index = _impl->index;
+    index.resize(_pool.size(), -1);
+    vector<bool> wanted(_pool.size(), false);
+    for (column_id const id : indep_sets) {
+        wanted[id] = true;
+    }
+    for (size_t id = 0; id < index.size(); id++) {
+        if (index[id] < 0) {
+            continue;
         }
+        column& col = _impl->vars[index[id]];
+        if (col.enabled and not wanted[id]) {
+            HANDLE_GRB_EXCEPTION(col.var.set(GRB_DoubleAttr_UB, 0.0));
+            col.enabled = false;
+        }
+    }
 
-        DCHECK_F(check_indep_sets(g, sets), "Invalid new sets.");
-
-        for (const node_set& set : sets) {
-            add_variable(model, vars, constrs, indep_sets, set);
+    // sets of the node that are disabled or missing in the master
+    vector<column_id> missing = {};
+    for (column_id const id : indep_sets) {
+        if (index[id] < 0 or not _impl->vars[index[id]].enabled) {
+            missing.push_back(id);
         }
     }
 
-    LOG_F(INFO, "Final model with %d sets.", (int)indep_sets.size());
+    add_columns(missing);
+    _impl->new_node = true;
+}
+
+cost Master::optimize()
+{
+    GRBModel& model = *_impl->model;
 
-    for (const node_set& set : indep_sets) {
-        x_s[set] = vars[set].get(GRB_DoubleAttr_X);
+    // The branching only changed bounds and right-hand sides, which keeps the
+    // last basis dual feasible: the dual simplex reaches the new optimum in a
+    // few pivots. Adding columns keeps it primal feasible instead.
+    HANDLE_GRB_EXCEPTION(
+        model.set(GRB_IntParam_Method, _impl->new_node ? 1 : 0));
+    _impl->new_node = false;
+    HANDLE_GRB_EXCEPTION(model.optimize());
+    if (model.get(GRB_IntAttr_Status) == GRB_INFEASIBLE) {
+        LOG_F(INFO, "Master LP is infeasible.");
+        return numeric_limits<cost>::infinity();
     }
 
-    // Return the dual objective solution
-    cost sum = 0;
-    for_nodes(g, u) {
-        sum += EPS * floor(weight[u] / EPS);
+    LOG_F(INFO,
+          "Solved in %lf (%.0lf iterations) with value %lf",
+          model.get(GRB_DoubleAttr_Runtime),
+          model.get(GRB_DoubleAttr_IterCount),
+          model.get(GRB_DoubleAttr_ObjVal));
+
+    return model.get(GRB_DoubleAttr_ObjVal);
+}
+
+void Master::get_duals(const Graph& g, vector<cost>& weight) const
+{
+    for_nodes(g, v) {
+        weight[v] = _impl->constrs[v].get(GRB_DoubleAttr_Pi);
     }
-    // TODO no caso de variáveis de corte, isso deve ser ceil
-    // conferir o paper do Lotti
-    return sum;
+}
+
+cost Master::get_value(column_id id) const
+{
+    return _impl->vars[_impl->index[id]].var.get(GRB_DoubleAttr_X);
+}
+
+void Master::log_stats() const
+{
+    LOG_F(INFO,
+          "Master with %lu columns (%d updates, %lf inserting in total).",
+          _impl->vars.size(),
+          _impl->n_updates,
+          _impl->insert_time);
 }
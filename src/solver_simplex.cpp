@@ -0,0 +1,891 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "../incl/solver.hpp"
+
+#include "../incl/utils.hpp"
+
+/*
+** Built-in backend: a bounded primal and dual simplex specialised for the
+** covering LP of the master,
+**     min sum x_j  s.t.  A x - r = 0,  r_i >= b_i,  0 <= x_j <= u_j,
+** where A is the 0/1 matrix of the independent sets, r_i is the surplus
+** variable of the row of node i (b_i is 1 if the node is active, 0 if not)
+** and u_j is 0 for the columns that are not in the current node.
+** Variable v < m is the surplus of row v and m + j is the column j. Nonbasic
+** variables always sit at their lower bound.
+*/
+
+static const double INF = numeric_limits<double>::infinity();
+
+/*
+** LU factorization of a basis. It has one column per row, either the surplus
+** of a row (-e_i) or an independent set. Permuting the rows whose surplus is
+** basic to the top gives
+**     B = | -I  T_s |
+**         |  0  T_t |
+** so only the square bump T_t is factorized, by a left-looking sparse LU
+** with partial pivoting. Later pivots are kept as eta vectors (product form)
+** until the next factorization.
+*/
+class basis_lu
+{
+  public:
+    /*
+    ** Factorize the basis given by the variable at each position. The
+    ** positions whose columns depend on the others are returned in
+    ** singular, with as many rows left without a pivot in free_rows.
+    */
+    void factorize(int n_rows,
+                   const vector<int>& head,
+                   const vector<vector<node>>& cols,
+                   vector<int>& singular,
+                   vector<node>& free_rows);
+
+    // B^-1 a, from a dense vector over the rows to one over the positions
+    void ftran(vector<double>& a) const;
+    // c B^-1, from a dense vector over the positions to one over the rows
+    void btran(vector<double>& c) const;
+    // the column at position p was replaced by one with B^-1 a = alpha
+    void update(int p, const vector<double>& alpha);
+
+    int get_n_etas() const { return etas.size(); }
+
+  private:
+    struct step
+    {
+        int pos;
+        node row;  // pivot row
+        double diag;
+        vector<pair<int, double>> u;   // entries of U above the diagonal
+        vector<pair<node, double>> l;  // multipliers of the elimination
+        vector<node> surplus_rows;     // entries of the column in T_s
+    };
+
+    struct eta
+    {
+        int pos;
+        double pivot;
+        vector<pair<int, double>> col;
+    };
+
+    int m = 0;
+    vector<int> surplus_pos;  // position of the surplus of each row, or -1
+    vector<step> steps;
+    vector<eta> etas;
+};
+
+void basis_lu::factorize(int n_rows,
+                         const vector<int>& head,
+                         const vector<vector<node>>& cols,
+                         vector<int>& singular,
+                         vector<node>& free_rows)
+{
+    m = n_rows;
+    steps.clear();
+    etas.clear();
+    singular.clear();
+    free_rows.clear();
+
+    surplus_pos.assign(m, -1);
+    vector<int> bump = {};
+    for (int p = 0; p < m; p++) {
+        if (head[p] < m) {
+            surplus_pos[head[p]] = p;
+        } else {
+            bump.push_back(p);
+        }
+    }
+
+    // columns with fewer entries in the bump first, to reduce the fill-in
+    vector<int> count(m, 0);
+    for (int p : bump) {
+        for (node i : cols[head[p] - m]) {
+            count[p] += surplus_pos[i] < 0;
+        }
+    }
+    stable_sort(bump.begin(), bump.end(), [&count](int a, int b) {
+        return count[a] < count[b];
+    });
+
+    // the work column is dense, but only the rows in its pattern are read
+    // and cleared
+    vector<double> w(m, 0.0);
+    vector<bool> in_pattern(m, false);
+    vector<node> pattern = {};
+    auto const touch = [&](node i) {
+        if (not in_pattern[i]) {
+            in_pattern[i] = true;
+            pattern.push_back(i);
+        }
+    };
+    vector<bool> pivoted(m, false);
+    for (int p : bump) {
+        step s = {p, 0, 0.0, {}, {}, {}};
+        for (node i : cols[head[p] - m]) {
+            if (surplus_pos[i] >= 0) {
+                s.surplus_rows.push_back(i);
+            } else {
+                w[i] = 1.0;
+                touch(i);
+            }
+        }
+
+        // apply the eliminations so far, which also gives the column of U
+        for (size_t t = 0; t < steps.size(); t++) {
+            double const wr = w[steps[t].row];
+            if (wr == 0.0) {
+                continue;
+            }
+            s.u.push_back({t, wr});
+            for (auto const& [i, l] : steps[t].l) {
+                w[i] -= l * wr;
+                touch(i);
+            }
+        }
+
+        // in the order of the rows, so ties go to the first row
+        sort(pattern.begin(), pattern.end());
+        double best = 0.0;
+        for (node const i : pattern) {
+            if (not pivoted[i] and fabs(w[i]) > best) {
+                best = fabs(w[i]);
+                s.row = i;
+            }
+        }
+        if (best >= SIMPLEX_PIVOT_TOL) {
+            s.diag = w[s.row];
+            pivoted[s.row] = true;
+            for (node const i : pattern) {
+                if (not pivoted[i] and w[i] != 0.0) {
+                    s.l.push_back({i, w[i] / s.diag});
+                }
+            }
+            steps.push_back(std::move(s));
+        } else {
+            singular.push_back(p);
+        }
+        for (node const i : pattern) {
+            w[i] = 0.0;
+            in_pattern[i] = false;
+        }
+        pattern.clear();
+    }
+
+    for (node i = 0; i < m; i++) {
+        if (surplus_pos[i] < 0 and not pivoted[i]) {
+            free_rows.push_back(i);
+        }
+    }
+}
+
+void basis_lu::ftran(vector<double>& a) const
+{
+    // T_t z_t = a_t
+    vector<double> w = a;
+    for (const step& s : steps) {
+        double const wr = w[s.row];
+        if (wr == 0.0) {
+            continue;
+        }
+        for (auto const& [i, l] : s.l) {
+            w[i] -= l * wr;
+        }
+    }
+    vector<double> g(steps.size());
+    for (size_t t = 0; t < steps.size(); t++) {
+        g[t] = w[steps[t].row];
+    }
+
+    // z_s = T_s z_t - a_s
+    vector<double> z(m, 0.0);
+    for (node i = 0; i < m; i++) {
+        if (surplus_pos[i] >= 0) {
+            z[surplus_pos[i]] = -a[i];
+        }
+    }
+    for (int t = (int)steps.size() - 1; t >= 0; t--) {
+        const step& s = steps[t];
+        double const v = g[t] / s.diag;
+        z[s.pos] = v;
+        if (v == 0.0) {
+            continue;
+        }
+        for (auto const& [k, u] : s.u) {
+            g[k] -= u * v;
+        }
+        for (node i : s.surplus_rows) {
+            z[surplus_pos[i]] += v;
+        }
+    }
+
+    for (const eta& e : etas) {
+        double const zp = z[e.pos] / e.pivot;
+        z[e.pos] = zp;
+        if (zp == 0.0) {
+            continue;
+        }
+        for (auto const& [i, ai] : e.col) {
+            z[i] -= ai * zp;
+        }
+    }
+    a = std::move(z);
+}
+
+void basis_lu::btran(vector<double>& c) const
+{
+    for (auto e = etas.rbegin(); e != etas.rend(); ++e) {
+        double sum = c[e->pos];
+        for (auto const& [i, ai] : e->col) {
+            sum -= ai * c[i];
+        }
+        c[e->pos] = sum / e->pivot;
+    }
+
+    // y_s = -c_s
+    vector<double> y(m, 0.0);
+    for (node i = 0; i < m; i++) {
+        if (surplus_pos[i] >= 0) {
+            y[i] = -c[surplus_pos[i]];
+        }
+    }
+
+    // T_t^T y_t = c_t - T_s^T y_s
+    vector<double> g(steps.size());
+    for (size_t t = 0; t < steps.size(); t++) {
+        const step& s = steps[t];
+        double v = c[s.pos];
+        for (node i : s.surplus_rows) {
+            v -= y[i];
+        }
+        for (auto const& [k, u] : s.u) {
+            v -= u * g[k];
+        }
+        g[t] = v / s.diag;
+        y[s.row] = g[t];
+    }
+    for (int t = (int)steps.size() - 1; t >= 0; t--) {
+        double sum = 0.0;
+        for (auto const& [i, l] : steps[t].l) {
+            sum += l * y[i];
+        }
+        y[steps[t].row] -= sum;
+    }
+    c = std::move(y);
+}
+
+void basis_lu::update(int p, const vector<double>& alpha)
+{
+    eta e = {p, alpha[p], {}};
+    for (int i = 0; i < m; i++) {
+        if (i != p and alpha[i] != 0.0) {
+            e.col.push_back({i, alpha[i]});
+        }
+    }
+    etas.push_back(std::move(e));
+}
+
+struct Master::impl
+{
+    int m = 0;  // one row for each node of the original graph
+    vector<vector<node>> cols;
+    vector<column_id> ids;  // set of each column
+    vector<int> index;  // column of each set of the pool, -1 if it has none
+
+    // bounds and value of each variable
+    vector<double> lb, ub, x;
+    // basis position of each variable (-1 if nonbasic) and the variable at
+    // each position
+    vector<int> pos, head;
+    vector<double> y;  // dual value of each row
+    // perturbation of the cost of each variable, only in a dual simplex
+    // that stalled
+    vector<double> shift;
+    basis_lu lu;
+    // the bounds changed, so the basic values must be recomputed
+    bool stale = true;
+
+    int iterations = 0;
+    int dual_iterations = 0;
+    int refactors = 0;
+    size_t deleted = 0;
+    double solve_time = 0;
+
+    int get_n_vars() const { return m + cols.size(); }
+    bool is_fixed(int v) const { return ub[v] <= lb[v]; }
+
+    double cost_of(int v) const
+    {
+        return (v < m ? 0.0 : 1.0) + (shift.empty() ? 0.0 : shift[v]);
+    }
+
+    double reduced_cost(int v) const
+    {
+        if (v < m) {
+            return cost_of(v) + y[v];
+        }
+        double d = cost_of(v);
+        for (node i : cols[v - m]) {
+            d -= y[i];
+        }
+        return d;
+    }
+
+    // the row vector r times the column of v
+    double dot(const vector<double>& r, int v) const
+    {
+        if (v < m) {
+            return -r[v];
+        }
+        double sum = 0.0;
+        for (node i : cols[v - m]) {
+            sum += r[i];
+        }
+        return sum;
+    }
+
+    vector<double> column(int v) const
+    {
+        vector<double> a(m, 0.0);
+        if (v < m) {
+            a[v] = -1.0;
+        } else {
+            for (node i : cols[v - m]) {
+                a[i] = 1.0;
+            }
+        }
+        return a;
+    }
+
+    void refactor();
+    void compact(const vector<bool>& drop);
+    void compute_primal();
+    void compute_duals();
+    void pivot(int q, int p, double theta, const vector<double>& alpha);
+    bool dual_simplex(int max_pivots);
+    bool primal_simplex(bool perturb);
+};
+
+Master::Master(const ColumnPool& pool)
+    : _pool(pool)
+    , _impl(make_unique<impl>())
+{
+}
+
+Master::~Master() = default;
+
+/*
+** Factorize the basis again, replacing the dependent columns by surplus
+** variables, and recompute the basic values.
+*/
+void Master::impl::refactor()
+{
+    while (true) {
+        vector<int> singular = {};
+        vector<node> free_rows = {};
+        lu.factorize(m, head, cols, singular, free_rows);
+        refactors++;
+        if (singular.empty()) {
+            break;
+        }
+        LOG_F(WARNING, "Replacing %lu dependent columns.", singular.size());
+        for (size_t k = 0; k < singular.size(); k++) {
+            int const p = singular[k];
+            pos[head[p]] = -1;
+            x[head[p]] = lb[head[p]];
+            head[p] = free_rows[k];
+            pos[free_rows[k]] = p;
+        }
+    }
+    compute_primal();
+}
+
+/*
+** Delete the columns marked in drop that are nonbasic; the basic ones are
+** fixed to 0 and stay until they leave the basis. The basis keeps its
+** positions, so its factors still hold.
+*/
+void Master::impl::compact(const vector<bool>& drop)
+{
+    size_t kept = 0;
+    for (size_t j = 0; j < cols.size(); j++) {
+        int const v = m + j;
+        if (drop[j] and pos[v] >= 0) {
+            ub[v] = 0.0;
+        }
+        if (drop[j] and pos[v] < 0) {
+            index[ids[j]] = -1;
+            continue;
+        }
+        int const w = m + kept;
+        if (w != v) {
+            cols[kept] = std::move(cols[j]);
+            ids[kept] = ids[j];
+            lb[w] = lb[v];
+            ub[w] = ub[v];
+            x[w] = x[v];
+            pos[w] = pos[v];
+            if (pos[w] >= 0) {
+                head[pos[w]] = w;
+            }
+            index[ids[kept]] = kept;
+        }
+        kept++;
+    }
+    deleted += cols.size() - kept;
+    cols.resize(kept);
+    ids.resize(kept);
+    lb.resize(m + kept);
+    ub.resize(m + kept);
+    x.resize(m + kept);
+    pos.resize(m + kept);
+}
+
+void Master::impl::compute_primal()
+{
+    // B x_B = -N x_N
+    vector<double> rhs(m, 0.0);
+    for (int v = 0; v < get_n_vars(); v++) {
+        if (pos[v] >= 0 or x[v] == 0.0) {
+            continue;
+        }
+        if (v < m) {
+            rhs[v] += x[v];
+        } else {
+            for (node i : cols[v - m]) {
+                rhs[i] -= x[v];
+            }
+        }
+    }
+    lu.ftran(rhs);
+    for (int p = 0; p < m; p++) {
+        x[head[p]] = rhs[p];
+    }
+    stale = false;
+}
+
+void Master::impl::compute_duals()
+{
+    y.assign(m, 0.0);
+    for (int p = 0; p < m; p++) {
+        y[p] = cost_of(head[p]);
+    }
+    lu.btran(y);
+}
+
+/*
+** Variable q enters the basis at position p, moving by theta along the
+** direction alpha = B^-1 a_q, and the variable at p leaves. Only fixed
+** variables have a finite upper bound, so it leaves at its lower bound.
+*/
+void Master::impl::pivot(int q, int p, double theta, const vector<double>& alpha)
+{
+    int const v = head[p];
+    for (int r = 0; r < m; r++) {
+        x[head[r]] -= theta * alpha[r];
+    }
+    x[q] += theta;
+    x[v] = lb[v];
+    pos[v] = -1;
+    head[p] = q;
+    pos[q] = p;
+
+    iterations++;
+    lu.update(p, alpha);
+    if (lu.get_n_etas() >= SIMPLEX_REFACTOR) {
+        refactor();
+    }
+}
+
+/*
+** Dual simplex from a basis whose reduced costs, with the costs shifted by
+** shift, are nonnegative. The largest infeasibility leaves and the Harris
+** ratio test picks the entering variable. After SIMPLEX_DUAL_DEGENERATE pivots
+** in a row that leave the duals where they were, the costs of the nonbasic
+** variables are raised by small distinct amounts, so that every pivot moves
+** the duals. The true costs are back at the end, and the primal simplex
+** prices in what they make negative. With a max_pivots, it gives up after
+** that many pivots. Returns false if it proves the LP infeasible, or gives up.
+** Once out of time it stops where it is.
+*/
+bool Master::impl::dual_simplex(int max_pivots)
+{
+    auto const perturb = [this]() {
+        shift.resize(get_n_vars(), 0.0);
+        for (int j = 0; j < get_n_vars(); j++) {
+            if (pos[j] < 0) {
+                // a fixed spread, so the runs are reproducible
+                shift[j] += SIMPLEX_PERTURBATION *
+                    (1.0 + (j * 2654435761u % 1024) / 1024.0);
+            }
+        }
+        LOG_F(INFO, "Perturbing the costs of the dual simplex.");
+    };
+
+    int degenerate = 0;
+    bool perturbed = false;
+    bool found = true;
+    for (int pivots = 0; not time_out(); pivots++) {
+        if (max_pivots > 0 and pivots >= max_pivots) {
+            LOG_F(INFO, "Dual simplex stalled after %d pivots.", pivots);
+            found = false;
+            break;
+        }
+        if (not perturbed and degenerate > SIMPLEX_DUAL_DEGENERATE) {
+            perturb();
+            perturbed = true;
+        }
+
+        // the basic variable with the largest infeasibility leaves
+        int p = -1;
+        double worst = SIMPLEX_TOL;
+        for (int r = 0; r < m; r++) {
+            int const v = head[r];
+            double const viol = max(lb[v] - x[v], x[v] - ub[v]);
+            if (viol > worst) {
+                worst = viol;
+                p = r;
+            }
+        }
+        if (p < 0) {
+            break;
+        }
+        int const v = head[p];
+        bool const below = x[v] < lb[v];
+
+        compute_duals();
+        vector<double> rho(m, 0.0);
+        rho[p] = 1.0;
+        lu.btran(rho);
+
+        // Harris ratio test: the largest pivot among the variables whose
+        // ratio is within the tolerance of the smallest one
+        vector<tuple<int, double, double>> candidates = {};
+        double limit = INF;
+        for (int j = 0; j < get_n_vars(); j++) {
+            if (pos[j] >= 0 or is_fixed(j)) {
+                continue;
+            }
+            double const a = dot(rho, j);
+            if (below ? a > -SIMPLEX_PIVOT_TOL : a < SIMPLEX_PIVOT_TOL) {
+                continue;
+            }
+            double const d = max(reduced_cost(j), 0.0);
+            candidates.push_back({j, fabs(a), d});
+            limit = min(limit, (d + SIMPLEX_TOL) / fabs(a));
+        }
+        if (candidates.empty()) {
+            found = false;
+            break;
+        }
+        int q = -1;
+        double size = 0.0;
+        double step = 0.0;
+        for (auto const& [j, a, d] : candidates) {
+            if (d / a <= limit and a > size) {
+                q = j;
+                size = a;
+                step = d / a;
+            }
+        }
+        degenerate = step < SIMPLEX_TOL ? degenerate + 1 : 0;
+
+        vector<double> alpha = column(q);
+        lu.ftran(alpha);
+        double const target = below ? lb[v] : ub[v];
+        pivot(q, p, (x[v] - target) / alpha[p], alpha);
+        dual_iterations++;
+    }
+
+    shift.clear();
+    return found;
+}
+
+/*
+** Primal simplex from a feasible basis, with Dantzig's rule and the Harris
+** ratio test. After SIMPLEX_DEGENERATE degenerate pivots in a row, with
+** perturb it lowers the lower bounds of the basic variables by small distinct
+** amounts, so that the next pivots move; without it, it goes to Bland's rule
+** until a nondegenerate pivot. The true bounds are back at the end, which may
+** leave the basis slightly infeasible: returns true if it perturbed them, and
+** the caller cleans up with a dual simplex. Once out of time it stops where it
+** is.
+*/
+bool Master::impl::primal_simplex(bool perturb)
+{
+    vector<double> true_lb = {};
+    int degenerate = 0;
+    while (not time_out()) {
+        if (perturb and true_lb.empty() and degenerate > SIMPLEX_DEGENERATE) {
+            true_lb = lb;
+            for (int r = 0; r < m; r++) {
+                int const v = head[r];
+                if (ub[v] == INF) {
+                    // a fixed spread, so the runs are reproducible
+                    lb[v] -= SIMPLEX_PERTURBATION *
+                        (1.0 + (v * 2654435761u % 1024) / 1024.0);
+                }
+            }
+            degenerate = 0;
+            LOG_F(INFO, "Perturbing the bounds of the primal simplex.");
+        }
+
+        compute_duals();
+        bool const bland = degenerate > SIMPLEX_DEGENERATE;
+        int q = -1;
+        double best = -SIMPLEX_TOL;
+        for (int v = 0; v < get_n_vars(); v++) {
+            if (pos[v] >= 0 or is_fixed(v)) {
+                continue;
+            }
+            double const d = reduced_cost(v);
+            if (d < best) {
+                q = v;
+                best = d;
+                if (bland) {
+                    break;
+                }
+            }
+        }
+        if (q < 0) {
+            break;
+        }
+
+        vector<double> alpha = column(q);
+        lu.ftran(alpha);
+
+        // Harris ratio test, as in the dual
+        auto ratio = [this, &alpha](int r, double tol) {
+            int const v = head[r];
+            if (alpha[r] > SIMPLEX_PIVOT_TOL) {
+                return (x[v] - lb[v] + tol) / alpha[r];
+            }
+            if (alpha[r] < -SIMPLEX_PIVOT_TOL and ub[v] < INF) {
+                return (ub[v] - x[v] + tol) / -alpha[r];
+            }
+            return INF;
+        };
+        double limit = INF;
+        for (int r = 0; r < m; r++) {
+            limit = min(limit, ratio(r, SIMPLEX_TOL));
+        }
+        if (limit == INF) {
+            ABORT_F("Master LP is unbounded.");
+        }
+        int p = -1;
+        for (int r = 0; r < m; r++) {
+            if (ratio(r, 0.0) > limit) {
+                continue;
+            }
+            if (p < 0 or (bland ? head[r] < head[p]
+                                : fabs(alpha[r]) > fabs(alpha[p]))) {
+                p = r;
+            }
+        }
+
+        double const theta = max(ratio(p, 0.0), 0.0);
+        degenerate = theta < SIMPLEX_TOL ? degenerate + 1 : 0;
+        pivot(q, p, theta, alpha);
+    }
+
+    if (true_lb.empty()) {
+        return false;
+    }
+    lb = true_lb;
+    for (int v = 0; v < get_n_vars(); v++) {
+        if (pos[v] < 0) {
+            x[v] = lb[v];
+        }
+    }
+    compute_primal();
+    return true;
+}
+
+void Master::add_columns(const vector<column_id>& sets)
+{
+    vector<int>& index = _impl->index;
+    index.resize(_pool.size(), -1);
+    for (column_id const id : sets) {
+        if (index[id] >= 0) {
+            int const v = _impl->m + index[id];
+            if (not _impl->is_fixed(v)) {
+                LOG_F(ERROR, "Skipping set already exists.");
+            }
+            // the set was fixed to 0 by another node
+            _impl->ub[v] = INF;
+            continue;
+        }
+
+        ColumnPool::members const set = _pool.get_members(id);
+        index[id] = _impl->cols.size();
+        _impl->cols.push_back({set.begin(), set.end()});
+        _impl->ids.push_back(id);
+        _impl->lb.push_back(0.0);
+        _impl->ub.push_back(INF);
+        _impl->x.push_back(0.0);
+        _impl->pos.push_back(-1);
+    }
+}
+
+void Master::remove_columns(const vector<column_id>& sets)
+{
+    vector<bool> drop(_impl->cols.size(), false);
+    for (column_id const id : sets) {
+        drop[_impl->index[id]] = true;
+    }
+    _impl->compact(drop);
+}
+
+/*
+** The right-hand side of the rows of inactive nodes becomes 0 and the columns
+** of sets that are not in the node are fixed to 0, and deleted once they are
+** many. The basis is kept, so the next optimize starts from the one of the
+** last solve.
+*/
+void Master::sync(const Graph& g, const vector<column_id>& indep_sets)
+{
+    impl& lp = *_impl;
+    if (lp.m == 0) {
+        // start from the basis of the surpluses
+        lp.m = g.get_n();
+        lp.lb.assign(lp.m, 1.0);
+        lp.ub.assign(lp.m, INF);
+        lp.x.assign(lp.m, 0.0);
+        for (int i = 0; i < lp.m; i++) {
+            lp.pos.push_back(i);
+            lp.head.push_back(i);
+        }
+    }
+
+    for (int i = 0; i < lp.m; i++) {
+        lp.lb[i] = g.is_active(i) ? 1.0 : 0.0;
+        if (lp.pos[i] < 0) {
+            lp.x[i] = lp.lb[i];
+        }
+    }
+
+    lp.index.resize(_pool.size(), -1);
+    vector<bool> wanted(_pool.size(), false);
+    for (column_id const id : indep_sets) {
+        wanted[id] = true;
+    }
+    for (size_t id = 0; id < lp.index.size(); id++) {
+        if (lp.index[id] >= 0 and not wanted[id]) {
+            lp.ub[lp.m + lp.index[id]] = 0.0;
+        }
+    }
+    vector<bool> drop(lp.cols.size(), false);
+    size_t n_fixed = 0;
+    for (size_t j = 0; j < lp.cols.size(); j++) {
+        drop[j] = lp.is_fixed(lp.m + j);
+        n_fixed += drop[j] ? 1 : 0;
+    }
+    if (n_fixed > SIMPLEX_COMPACT * lp.cols.size()) {
+        lp.compact(drop);
+    }
+
+    // sets of the node that are disabled or missing in the master
+    vector<column_id> missing = {};
+    for (column_id const id : indep_sets) {
+        if (lp.index[id] < 0 or lp.is_fixed(lp.m + lp.index[id])) {
+            missing.push_back(id);
+        }
+    }
+
+    add_columns(missing);
+    lp.stale = true;
+}
+
+/*
+** The branching only changes bounds, which keeps the last basis dual
+** feasible, and new columns keep it primal feasible, so most solves are
+** either a dual or a primal simplex from a warm start. When both happen, the
+** costs of the columns with a negative reduced cost are shifted up to make it
+** dual feasible, and the primal simplex prices them in with their true cost
+** after the dual one. Once out of time, the basis it stops at may be neither
+** optimal nor feasible.
+*/
+cost Master::optimize()
+{
+    impl& lp = *_impl;
+    auto const start = chrono::steady_clock::now();
+    int const iterations = lp.iterations;
+    int const dual_iterations = lp.dual_iterations;
+
+    if (lp.stale) {
+        lp.refactor();
+    }
+    lp.compute_duals();
+    lp.shift.assign(lp.get_n_vars(), 0.0);
+    for (int v = 0; v < lp.get_n_vars(); v++) {
+        if (lp.pos[v] < 0 and not lp.is_fixed(v)) {
+            lp.shift[v] = max(-lp.reduced_cost(v), 0.0);
+        }
+    }
+    if (not lp.dual_simplex(SIMPLEX_MAX_PIVOTS)) {
+        // start again from the basis of the surpluses, which is dual feasible
+        LOG_F(INFO, "Restarting the master from the surplus basis.");
+        for (int v = 0; v < lp.get_n_vars(); v++) {
+            lp.pos[v] = -1;
+            lp.x[v] = lp.lb[v];
+        }
+        for (int i = 0; i < lp.m; i++) {
+            lp.pos[i] = i;
+            lp.head[i] = i;
+        }
+        lp.refactor();
+        if (not lp.dual_simplex(0)) {
+            LOG_F(INFO, "Master LP is infeasible.");
+            return numeric_limits<cost>::infinity();
+        }
+    }
+    if (lp.primal_simplex(true) and not time_out()) {
+        // back to the true bounds, the basis is still optimal for the costs
+        lp.dual_simplex(0);
+        lp.primal_simplex(false);
+    }
+
+    double obj = 0.0;
+    for (size_t j = 0; j < lp.cols.size(); j++) {
+        obj += lp.x[lp.m + j];
+    }
+
+    double const elapsed =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    lp.solve_time += elapsed;
+    LOG_F(INFO,
+          "Solved in %lf (%d iterations, %d in the dual) with value %lf",
+          elapsed,
+          lp.iterations - iterations,
+          lp.dual_iterations - dual_iterations,
+          obj);
+
+    return obj;
+}
+
+void Master::get_duals(const Graph& g, vector<cost>& weight) const
+{
+    for_nodes(g, v) {
+        weight[v] = _impl->y[v];
+    }
+}
+
+cost Master::get_value(column_id id) const
+{
+    return _impl->x[_impl->m + _impl->index[id]];
+}
+
+void Master::log_stats() const
+{
+    LOG_F(INFO,
+          "Master with %lu columns, %lu deleted (%d iterations, %d "
+          "factorizations, %lf solving in total).",
+          _impl->cols.size(),
+          _impl->deleted,
+          _impl->iterations,
+          _impl->refactors,
+          _impl->solve_time);
+}
@@ -1,12 +1,86 @@
 
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <thread>
 
 #include "../incl/utils.hpp"
 
 #define MAX_GENERATED_SET 100
 
+Config config = {
+    SINGLE_THREAD ? 1 : max(1U, thread::hardware_concurrency()),
+    false,
+    1,
+    0,
+    "",
+    "",
+    "",
+    "",
+    TIMELIMIT,
+};
+
+static auto const start = chrono::steady_clock::now();
+
+double elapsed()
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+        .count();
+}
+
+bool time_out()
+{
+    return elapsed() >= config.time_limit;
+}
+
+void parse_args(int argc, char** argv)
+{
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 and i + 1 < argc) {
+            config.threads = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--reproducible") == 0) {
+            config.reproducible = true;
+        } else if (strcmp(argv[i], "--tree-threads") == 0 and i + 1 < argc) {
+            config.tree_threads = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--workers") == 0 and i + 1 < argc) {
+            config.workers = max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--listen") == 0 and i + 1 < argc) {
+            config.listen = argv[++i];
+        } else if (strcmp(argv[i], "--connect") == 0 and i + 1 < argc) {
+            config.connect = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint") == 0 and i + 1 < argc) {
+            config.checkpoint = argv[++i];
+        } else if (strcmp(argv[i], "--resume") == 0 and i + 1 < argc) {
+            config.resume = argv[++i];
+        } else if (strcmp(argv[i], "--time-limit") == 0 and i + 1 < argc) {
+            config.time_limit = atof(argv[++i]);
+        } else {
+            ABORT_F("Unknown option %s.", argv[i]);
+        }
+    }
+    if (config.checkpoint.empty()) {
+        config.checkpoint = config.resume;
+    }
+    // only the sequential search takes checkpoints
+    if (not config.checkpoint.empty() and
+        (config.workers > 0 or
+         (config.tree_threads > 1 and not config.reproducible))) {
+        ABORT_F("--checkpoint and --resume need a sequential search.");
+    }
+    // each tree worker prices with its own threads, so they share the cores
+    if (config.tree_threads > 1 and not config.reproducible) {
+        config.threads = max(1U, config.threads / config.tree_threads);
+    }
+    LOG_F(INFO,
+          "Config: %u pricing threads%s, %u tree threads, %.0lf s.",
+          config.threads,
+          config.reproducible ? ", reproducible" : "",
+          config.tree_threads,
+          config.time_limit);
+}
+
 string to_string(const node_set& set)
 {
     string s = "{";
@@ -20,15 +94,28 @@ string to_string(const node_set& set)
     return s;
 }
 
+size_t node_set_hash::operator()(const node_set& set) const
+{
+    // splitmix64 finalizer over the sequence of nodes
+    uint64_t h = set.size();
+    for (node const u : set) {
+        h += 0x9e3779b97f4a7c15ULL + u;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+    }
+    return h;
+}
+
 void log_solution(const Graph& g,
                   const vector<node_set>& indep_sets,
-                  map<node_set, cost>& x_s,
+                  const vector<cost>& x_s,
                   const cost& sol)
 {
     vector<node_set> sets_sol;
-    for (node_set const& set : indep_sets) {
-        if (x_s[set] >= 1 - EPS) {
-            sets_sol.push_back(set);
+    for (size_t i = 0; i < indep_sets.size(); i++) {
+        if (x_s[i] >= 1 - EPS) {
+            sets_sol.push_back(indep_sets[i]);
         }
     }
     g.apply_changes_to_sol(sets_sol);
@@ -39,9 +126,9 @@ void log_solution(const Graph& g,
     LOG_F(WARNING, log.c_str(), sol);
 }
 
-bool integral(const map<node_set, cost>& x_s)
+bool integral(const vector<cost>& x_s)
 {
-    for (const auto& [s, x] : x_s) {
+    for (cost const x : x_s) {
         if (0 + EPS < x and x < 1 - EPS) {
             LOG_F(INFO, "Not integer %Lf", x);
             return false;
@@ -163,6 +250,11 @@ Graph* read_dimacs_instance(const string& filename)
     return g;
 }
 
+void log_bound(const char* name, const cost& value)
+{
+    LOG_F(WARNING, "BOUND %.3lf %s %Lf", elapsed(), name, value);
+}
+
 void log_graph_stats(const Graph& g, const string& name)
 {
     LOG_F(INFO,